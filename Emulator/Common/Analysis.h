@@ -0,0 +1,223 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "Opcodes.h"
+#include "Symbols.h"
+#include "XXHash64.h"
+
+// Recursive descent analysis of a ROM image: follows every jump, call and
+// RST from the entry points and records which bytes are instructions,
+// which are their operands and which are only ever read as data, plus who
+// jumps to, calls or points at what.
+//
+// The result is saved to a small file keyed by the ROM's hash, so the
+// disassembler and anything else that wants code/data boundaries (the
+// profiler, a debugger) can load it instead of redoing the walk.
+class Analysis
+{
+public:
+   enum Kind : uint8_t
+   {
+      UNKNOWN, // Never reached nor referenced: usually data nobody points at directly
+      CODE,    // First byte of an instruction
+      OPERAND, // Later bytes of an instruction
+      DATA,    // Referenced by a 16 bit operand (LXI, LDA, LHLD...)
+   };
+
+   enum Reference : uint8_t { REF_JUMP, REF_CALL, REF_DATA };
+
+   struct Xref
+   {
+      uint16_t from; // Address of the instruction
+      uint16_t to;
+      uint8_t type;  // Reference
+   };
+
+   uint64_t romHash = 0;
+   std::vector<uint8_t> kind;      // One per ROM byte
+   std::vector<Xref> xrefs;        // Sorted by target, then source
+   std::vector<uint16_t> routines; // Entry points and every CALL/RST target, sorted
+   uint32_t overlaps = 0;          // Jumps into the middle of an instruction
+
+   static uint64_t hash(const uint8_t* rom, size_t size) { return XXHash64::hash(rom, size); }
+
+   // Reset is always an entry point. `entries` adds the interrupt vectors the
+   // hardware uses and routines only reached through PCHL tables; RST
+   // vectors are followed when an RST is found in the code.
+   void analyze(const uint8_t* rom, size_t size, const std::vector<uint16_t>& entries = {})
+   {
+      romHash = hash(rom, size);
+      kind.assign(size, UNKNOWN);
+      xrefs.clear();
+      routines.clear();
+      overlaps = 0;
+
+      std::vector<uint16_t> work = { 0 }; // Walked in order, so reset claims its bytes first
+      work.insert(work.end(), entries.begin(), entries.end());
+      routines = work;
+
+      for (size_t next = 0; next < work.size(); next++)
+      {
+         uint32_t pc = work[next];
+         while (pc < size && kind[pc] != CODE)
+         {
+            if (kind[pc] == OPERAND)
+            {
+               overlaps++;
+               break;
+            }
+            const Opcodes::Info& op = Opcodes::TABLE[rom[pc]];
+            if (pc + op.length > size)
+               break;
+            kind[pc] = CODE;
+            for (int n = 1; n < op.length; n++)
+               kind[pc + n] = OPERAND;
+
+            uint16_t operand = op.length == 3 ? rom[pc + 1] | rom[pc + 2] << 8 : 0;
+            bool fallsThrough = true;
+            switch (op.flow)
+            {
+            case Opcodes::FLOW_JUMP:
+               fallsThrough = false;
+               // Fall through
+            case Opcodes::FLOW_JUMP_IF:
+               xrefs.push_back({ (uint16_t)pc, operand, REF_JUMP });
+               work.push_back(operand);
+               break;
+            case Opcodes::FLOW_CALL:
+            case Opcodes::FLOW_CALL_IF:
+            case Opcodes::FLOW_RESTART:
+               if (op.flow == Opcodes::FLOW_RESTART)
+                  operand = Opcodes::restartAddress(rom[pc]);
+               xrefs.push_back({ (uint16_t)pc, operand, REF_CALL });
+               routines.push_back(operand);
+               work.push_back(operand);
+               break;
+            case Opcodes::FLOW_RETURN:
+            case Opcodes::FLOW_INDIRECT:
+            case Opcodes::FLOW_HALT:
+               fallsThrough = false;
+               break;
+            default:
+               if (op.operand == Opcodes::OPERAND_WORD)
+                  xrefs.push_back({ (uint16_t)pc, operand, REF_DATA });
+               break;
+            }
+            if (!fallsThrough)
+               break;
+            pc += op.length;
+         }
+      }
+
+      for (const Xref& xref : xrefs)
+         if (xref.type == REF_DATA && xref.to < size && kind[xref.to] == UNKNOWN)
+            kind[xref.to] = DATA;
+
+      std::sort(xrefs.begin(), xrefs.end(), [](const Xref& a, const Xref& b) { return a.to != b.to ? a.to < b.to : a.from < b.from; });
+      std::sort(routines.begin(), routines.end());
+      routines.erase(std::unique(routines.begin(), routines.end()), routines.end());
+   }
+
+   // References to `address` are [first, last)
+   void referencesTo(uint16_t address, const Xref*& first, const Xref*& last) const
+   {
+      auto range = std::equal_range(xrefs.begin(), xrefs.end(), Xref{ 0, address, 0 },
+         [](const Xref& a, const Xref& b) { return a.to < b.to; });
+      first = xrefs.data() + (range.first - xrefs.begin());
+      last = xrefs.data() + (range.second - xrefs.begin());
+   }
+
+   bool isRoutine(uint16_t address) const { return std::binary_search(routines.begin(), routines.end(), address); }
+
+   // The routine an address belongs to: the nearest entry at or below it
+   uint16_t routineOf(uint16_t address) const
+   {
+      auto it = std::upper_bound(routines.begin(), routines.end(), address);
+      return it == routines.begin() ? 0 : *(it - 1);
+   }
+
+   size_t count(Kind which) const { return std::count(kind.begin(), kind.end(), (uint8_t)which); }
+
+   // File: "8080ANA1", ROM hash, ROM size, overlaps, kinds, routine count,
+   // routines, xref count, xrefs (from, to, type). Little endian.
+   bool save(const std::string& path) const
+   {
+      std::ofstream stream(path, std::ios::binary);
+      stream.write(magic(), 8);
+      put(stream, romHash);
+      put(stream, (uint32_t)kind.size());
+      put(stream, overlaps);
+      stream.write((const char*)kind.data(), kind.size());
+      put(stream, (uint32_t)routines.size());
+      for (uint16_t routine : routines)
+         put(stream, routine);
+      put(stream, (uint32_t)xrefs.size());
+      for (const Xref& xref : xrefs)
+      {
+         put(stream, xref.from);
+         put(stream, xref.to);
+         put(stream, xref.type);
+      }
+      return (bool)stream;
+   }
+
+   // False if the file is missing, damaged or was made from another ROM
+   bool load(const std::string& path, uint64_t expectedHash)
+   {
+      std::ifstream stream(path, std::ios::binary);
+      char header[8];
+      uint32_t size, routineCount, xrefCount;
+      if (!stream.read(header, 8) || std::string(header, 8) != magic())
+         return false;
+      if (!get(stream, romHash) || romHash != expectedHash || !get(stream, size) || !get(stream, overlaps) || size > 0x10000)
+         return false;
+      kind.resize(size);
+      if (!stream.read((char*)kind.data(), size) || !get(stream, routineCount) || routineCount > 0x10000)
+         return false;
+      routines.resize(routineCount);
+      for (uint16_t& routine : routines)
+         if (!get(stream, routine))
+            return false;
+      if (!get(stream, xrefCount) || xrefCount > 0x30000)
+         return false;
+      xrefs.resize(xrefCount);
+      for (Xref& xref : xrefs)
+         if (!get(stream, xref.from) || !get(stream, xref.to) || !get(stream, xref.type))
+            return false;
+      return true;
+   }
+
+   // The analysis the tools share: RST 1 and RST 2 (the video interrupts)
+   // and every code symbol as entry points, the symbols also reaching the
+   // game object handlers called through PCHL. Loaded from `cacheFile`
+   // when it was made from this ROM and has all of them as routines (a
+   // cache from a smaller map is missing some), otherwise analyzed and
+   // saved there; a failed save is reported to `warnings`. True if the
+   // cache was used.
+   bool loadOrAnalyze(const std::vector<uint8_t>& rom, const Symbols& symbols, const std::string& cacheFile, bool useCache, std::ostream& warnings)
+   {
+      std::vector<uint16_t> entries = { 0x08, 0x10 };
+      for (const Symbols::Symbol& symbol : symbols.all())
+         if (symbol.type == Symbols::CODE && symbol.address < rom.size())
+            entries.push_back(symbol.address);
+
+      auto isRoutine = [this](uint16_t entry) { return this->isRoutine(entry); };
+      if (useCache && load(cacheFile, hash(rom.data(), rom.size())) && std::all_of(entries.begin(), entries.end(), isRoutine))
+         return true;
+      analyze(rom.data(), rom.size(), entries);
+      if (!save(cacheFile))
+         warnings << "Can't write " << cacheFile << std::endl;
+      return false;
+   }
+
+private:
+   static const char* magic() { return "8080ANA1"; }
+
+   template <typename T> static void put(std::ofstream& stream, T value) { stream.write((const char*)&value, sizeof(T)); }
+   template <typename T> static bool get(std::ifstream& stream, T& value) { return (bool)stream.read((char*)&value, sizeof(T)); }
+};
@@ -0,0 +1,345 @@
+#pragma once
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "Symbols.h"
+
+// A breakpoint condition such as "PC==0x08F3 && HL>=0x2400 && mem[0x20F8]==0",
+// parsed once and compiled to a small stack bytecode, so checking it costs
+// a few dozen operations instead of a parse.
+//
+//    Numbers    123, 0x7b, $7b
+//    Registers  A B C D E H L, BC DE HL SP PC PSW (A and the flags byte),
+//               flags CY Z S P AC (0 or 1); any case
+//    Memory     mem[x] for a byte, word[x] for a little endian word
+//    Symbols    any other name, as its address: PC==PrintMessage && mem[isrDelay]==0
+//    Operators  as in C: ! ~ - (unary), * / %, + -, << >>, < <= > >=,
+//               == !=, &, ^, |, &&, ||, and parentheses
+//
+// Values are 32 bit signed, so 16 bit registers compare the way they read.
+// anchor() finds a "PC==n" (or "n==PC") joined to the rest by && at the
+// top level: the only address the condition can be true at.
+class Condition
+{
+public:
+   enum Register { REG_A, REG_B, REG_C, REG_D, REG_E, REG_H, REG_L, REG_BC, REG_DE, REG_HL, REG_SP, REG_PC, REG_PSW,
+      REG_CY, REG_Z, REG_S, REG_P, REG_AC, REGISTERS };
+
+   Condition() {}
+
+   // Throws a std::string saying what is wrong and where. Register names
+   // win over symbols of the same name.
+   explicit Condition(const std::string& text, const Symbols* symbols = nullptr) : text(text), symbols(symbols)
+   {
+      position = 0;
+      int root = parse(1);
+      skipSpaces();
+      if (position < text.size())
+         fail("unexpected text");
+      if (emit(root, code) > STACK)
+         fail("too deeply nested");
+      int anchorNode = findAnchor(root);
+      if (anchorNode >= 0)
+      {
+         const Node& test = nodes[anchorNode];
+         anchorPC = (nodes[test.left].op == OP_NUMBER ? nodes[test.left].value : nodes[test.right].value) & 0xffff;
+         int rest = strip(root, anchorNode);
+         if (rest >= 0)
+            emit(rest, anchored);
+      }
+      nodes.clear();
+      this->symbols = nullptr;
+   }
+
+   const std::string& getText() const { return text; }
+   bool isEmpty() const { return code.empty(); } // No condition: always true
+   bool anchor(uint16_t& pc) const
+   {
+      pc = (uint16_t)anchorPC;
+      return anchorPC >= 0;
+   }
+
+   // registers: REGISTERS values, memory: the 64K address space
+   bool evaluate(const int32_t* registers, const uint8_t* memory) const
+   {
+      // At the anchor its PC==n test is known to hold
+      const std::vector<int32_t>& code = registers[REG_PC] == anchorPC ? anchored : this->code;
+      if (code.empty())
+         return true;
+      int32_t stack[STACK];
+      int top = -1;
+      for (size_t n = 0; n < code.size(); n++)
+      {
+         int32_t right;
+         switch (code[n])
+         {
+         case OP_SKIP_IF_FALSE: // && and || only evaluate their right side when it matters
+            if (!stack[top])
+               n = code[n + 1] - 1;
+            else
+               n++, top--;
+            continue;
+         case OP_SKIP_IF_TRUE:
+            if (stack[top])
+            {
+               stack[top] = 1;
+               n = code[n + 1] - 1;
+            }
+            else
+               n++, top--;
+            continue;
+         case OP_BOOLEAN: stack[top] = stack[top] != 0; continue;
+         case OP_NUMBER: stack[++top] = code[++n]; continue;
+         case OP_REGISTER: stack[++top] = registers[code[++n]]; continue;
+         case OP_BYTE: stack[top] = memory[(uint16_t)stack[top]]; continue;
+         case OP_WORD: stack[top] = memory[(uint16_t)stack[top]] | memory[(uint16_t)(stack[top] + 1)] << 8; continue;
+         case OP_NOT: stack[top] = !stack[top]; continue;
+         case OP_COMPLEMENT: stack[top] = ~stack[top]; continue;
+         case OP_NEGATE: stack[top] = -stack[top]; continue;
+         default: break;
+         }
+         right = stack[top--];
+         int32_t& left = stack[top];
+         switch (code[n])
+         {
+         case OP_MULTIPLY: left *= right; break;
+         case OP_DIVIDE: left = right ? left / right : 0; break;
+         case OP_MODULO: left = right ? left % right : 0; break;
+         case OP_ADD: left += right; break;
+         case OP_SUBTRACT: left -= right; break;
+         case OP_SHIFT_LEFT: left = (int32_t)((uint32_t)left << (right & 31)); break;
+         case OP_SHIFT_RIGHT: left >>= right & 31; break;
+         case OP_LESS: left = left < right; break;
+         case OP_LESS_EQUAL: left = left <= right; break;
+         case OP_GREATER: left = left > right; break;
+         case OP_GREATER_EQUAL: left = left >= right; break;
+         case OP_EQUAL: left = left == right; break;
+         case OP_NOT_EQUAL: left = left != right; break;
+         case OP_AND: left &= right; break;
+         case OP_XOR: left ^= right; break;
+         case OP_OR: left |= right; break;
+         }
+      }
+      return stack[0] != 0;
+   }
+
+private:
+   enum Op
+   {
+      OP_SKIP_IF_FALSE, OP_SKIP_IF_TRUE, OP_BOOLEAN, // Followed by where to skip to
+      OP_NUMBER, OP_REGISTER, OP_BYTE, OP_WORD, OP_NOT, OP_COMPLEMENT, OP_NEGATE, // Operands and unary
+      OP_MULTIPLY, OP_DIVIDE, OP_MODULO, OP_ADD, OP_SUBTRACT, OP_SHIFT_LEFT, OP_SHIFT_RIGHT,
+      OP_LESS, OP_LESS_EQUAL, OP_GREATER, OP_GREATER_EQUAL, OP_EQUAL, OP_NOT_EQUAL,
+      OP_AND, OP_XOR, OP_OR, OP_LOGICAL_AND, OP_LOGICAL_OR,
+   };
+
+   static const int STACK = 32;
+
+   struct Node
+   {
+      Op op;
+      int32_t value; // OP_NUMBER, OP_REGISTER
+      int left, right;
+   };
+
+   struct Binary
+   {
+      const char* text;
+      Op op;
+      int precedence;
+   };
+
+   std::string text;
+   std::vector<int32_t> code;
+   std::vector<int32_t> anchored; // The same without the anchor's PC==n
+   int32_t anchorPC = -1;
+
+   // Only while compiling
+   std::vector<Node> nodes;
+   size_t position = 0;
+   const Symbols* symbols = nullptr;
+
+   [[noreturn]] void fail(const char* what) const
+   {
+      throw std::string(what) + " at column " + std::to_string(position + 1) + ": " + text;
+   }
+
+   void skipSpaces()
+   {
+      while (position < text.size() && std::isspace((unsigned char)text[position]))
+         position++;
+   }
+
+   bool accept(const char* token)
+   {
+      skipSpaces();
+      size_t length = std::strlen(token);
+      if (text.compare(position, length, token) != 0)
+         return false;
+      position += length;
+      return true;
+   }
+
+   int node(Op op, int left = -1, int right = -1, int32_t value = 0)
+   {
+      nodes.push_back({ op, value, left, right });
+      return (int)nodes.size() - 1;
+   }
+
+   // Binary operators of at least `precedence`
+   int parse(int precedence)
+   {
+      // Longer spellings first, so "<=" is not read as "<"
+      static const Binary BINARY[] = {
+         { "||", OP_LOGICAL_OR, 1 }, { "&&", OP_LOGICAL_AND, 2 },
+         { "==", OP_EQUAL, 6 }, { "!=", OP_NOT_EQUAL, 6 },
+         { "<<", OP_SHIFT_LEFT, 8 }, { ">>", OP_SHIFT_RIGHT, 8 },
+         { "<=", OP_LESS_EQUAL, 7 }, { ">=", OP_GREATER_EQUAL, 7 }, { "<", OP_LESS, 7 }, { ">", OP_GREATER, 7 },
+         { "|", OP_OR, 3 }, { "^", OP_XOR, 4 }, { "&", OP_AND, 5 },
+         { "+", OP_ADD, 9 }, { "-", OP_SUBTRACT, 9 }, { "*", OP_MULTIPLY, 10 }, { "/", OP_DIVIDE, 10 }, { "%", OP_MODULO, 10 },
+      };
+
+      int left = unary();
+      for (;;)
+      {
+         const Binary* found = nullptr;
+         size_t start = position;
+         for (const Binary& binary : BINARY)
+            if (accept(binary.text))
+            {
+               found = &binary;
+               break;
+            }
+         if (!found || found->precedence < precedence)
+         {
+            position = start;
+            return left;
+         }
+         left = node(found->op, left, parse(found->precedence + 1)); // Left associative
+      }
+   }
+
+   int unary()
+   {
+      if (accept("!"))
+         return node(OP_NOT, unary());
+      if (accept("~"))
+         return node(OP_COMPLEMENT, unary());
+      if (accept("-"))
+         return node(OP_NEGATE, unary());
+      if (accept("("))
+      {
+         int inner = parse(1);
+         if (!accept(")"))
+            fail("expected )");
+         return inner;
+      }
+
+      skipSpaces();
+      if (position < text.size() && (std::isdigit((unsigned char)text[position]) || text[position] == '$'))
+      {
+         int base = 10; // Not C's octal: 0100 is a hundred
+         if (text[position] == '$')
+            position++, base = 16;
+         else if (text.compare(position, 2, "0x") == 0 || text.compare(position, 2, "0X") == 0)
+            position += 2, base = 16;
+         const char* start = text.c_str() + position;
+         char* end;
+         long value = std::strtol(start, &end, base);
+         if (end == start)
+            fail("expected a number");
+         position = end - text.c_str();
+         return node(OP_NUMBER, -1, -1, (int32_t)value);
+      }
+
+      size_t start = position;
+      while (position < text.size() && (std::isalnum((unsigned char)text[position]) || text[position] == '_'))
+         position++;
+      std::string symbol = text.substr(start, position - start);
+      std::string name = symbol;
+      for (char& c : name)
+         c = (char)std::toupper((unsigned char)c);
+      if (name == "MEM" || name == "WORD")
+      {
+         if (!accept("["))
+            fail("expected [");
+         int address = parse(1);
+         if (!accept("]"))
+            fail("expected ]");
+         return node(name == "MEM" ? OP_BYTE : OP_WORD, address);
+      }
+      static const char* NAMES[REGISTERS] = { "A", "B", "C", "D", "E", "H", "L", "BC", "DE", "HL", "SP", "PC", "PSW", "CY", "Z", "S", "P", "AC" };
+      for (int reg = 0; reg < REGISTERS; reg++)
+         if (name == NAMES[reg])
+            return node(OP_REGISTER, -1, -1, reg);
+      if (const Symbols::Symbol* found = symbols ? symbols->find(symbol) : nullptr)
+         return node(OP_NUMBER, -1, -1, found->address);
+      position = start;
+      fail(name.empty() ? "expected a value" : "unknown name");
+   }
+
+   // Postfix code for the tree at `index`; returns the stack depth it needs
+   int emit(int index, std::vector<int32_t>& out) const
+   {
+      const Node& n = nodes[index];
+      if (n.op == OP_NUMBER || n.op == OP_REGISTER)
+      {
+         out.push_back(n.op);
+         out.push_back(n.value);
+         return 1;
+      }
+      int depth = emit(n.left, out);
+      if (n.op == OP_LOGICAL_AND || n.op == OP_LOGICAL_OR)
+      {
+         out.push_back(n.op == OP_LOGICAL_AND ? OP_SKIP_IF_FALSE : OP_SKIP_IF_TRUE);
+         out.push_back(0);
+         size_t target = out.size() - 1;
+         depth = std::max(depth, emit(n.right, out)); // The left value was popped
+         out.push_back(OP_BOOLEAN);
+         out[target] = (int32_t)out.size();
+         return depth;
+      }
+      if (n.right >= 0)
+         depth = std::max(depth, 1 + emit(n.right, out));
+      out.push_back(n.op);
+      return depth;
+   }
+
+   // The PC==n test reached from the root through && only, or -1
+   int findAnchor(int index) const
+   {
+      const Node& n = nodes[index];
+      if (n.op == OP_LOGICAL_AND)
+      {
+         int found = findAnchor(n.left);
+         return found >= 0 ? found : findAnchor(n.right);
+      }
+      if (n.op != OP_EQUAL)
+         return -1;
+      const Node& left = nodes[n.left];
+      const Node& right = nodes[n.right];
+      if ((left.op == OP_REGISTER && left.value == REG_PC && right.op == OP_NUMBER)
+         || (right.op == OP_REGISTER && right.value == REG_PC && left.op == OP_NUMBER))
+         return index;
+      return -1;
+   }
+
+   // The tree at `index` with `removed` taken out of its && chain; -1 if nothing is left
+   int strip(int index, int removed)
+   {
+      if (index == removed)
+         return -1;
+      if (nodes[index].op != OP_LOGICAL_AND)
+         return index;
+      int left = strip(nodes[index].left, removed);
+      int right = strip(nodes[index].right, removed);
+      if (left < 0 || right < 0)
+         return left < 0 ? right : left;
+      return node(OP_LOGICAL_AND, left, right);
+   }
+};
@@ -0,0 +1,94 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+
+// Which bytes of the 64K address space a run executed, read as data and
+// wrote. Memory marks them as it goes and the run saves them as three 64K
+// bit bitmaps; Tools/CoverageMerge ORs the files of many runs together and
+// reports what none of them reached.
+//
+// While running each address has a whole byte per kind: marking is then a
+// plain store, which costs nothing measurable, where setting a bit is a
+// read, an OR and a write on every access. The bits are packed on save.
+//
+// Executed covers every byte of an instruction, its operands too; reads
+// are only the data reads (LDA, MOV r,M, POP...).
+class Coverage
+{
+public:
+   enum Kind { EXECUTED, READ, WRITTEN, KINDS };
+
+   uint64_t romHash = 0; // XXHash64 of the image the run loaded, so runs of another ROM don't mix
+   uint32_t runs = 1;    // How many runs were ORed into this one
+
+   void mark(Kind kind, uint16_t address) { marks[kind][address] = 1; }
+   bool test(Kind kind, uint16_t address) const { return marks[kind][address] != 0; }
+
+   // Marked addresses in [from, to)
+   uint32_t count(Kind kind, uint32_t from, uint32_t to) const
+   {
+      uint32_t total = 0;
+      for (uint32_t address = from; address < to; address++)
+         total += marks[kind][address];
+      return total;
+   }
+
+   // False when `other` is of another ROM
+   bool merge(const Coverage& other)
+   {
+      if (other.romHash != romHash)
+         return false;
+      for (int kind = 0; kind < KINDS; kind++)
+         for (uint32_t address = 0; address < 0x10000; address++)
+            marks[kind][address] |= other.marks[kind][address];
+      runs += other.runs;
+      return true;
+   }
+
+   // File: "8080COV1", ROM hash, runs, then the executed, read and written
+   // bitmaps of 8K bytes each, bit n of byte a/8 for address a. Little endian.
+   bool save(const std::string& path) const
+   {
+      std::ofstream stream(path, std::ios::binary);
+      stream.write(magic(), 8);
+      put(stream, romHash);
+      put(stream, runs);
+      uint8_t bits[0x10000 / 8];
+      for (int kind = 0; kind < KINDS; kind++)
+      {
+         std::memset(bits, 0, sizeof(bits));
+         for (uint32_t address = 0; address < 0x10000; address++)
+            bits[address >> 3] |= (uint8_t)(marks[kind][address] << (address & 7));
+         stream.write((const char*)bits, sizeof(bits));
+      }
+      return (bool)stream;
+   }
+
+   // False if the file is missing or damaged
+   bool load(const std::string& path)
+   {
+      std::ifstream stream(path, std::ios::binary);
+      char header[8];
+      if (!stream.read(header, 8) || std::string(header, 8) != magic() || !get(stream, romHash) || !get(stream, runs))
+         return false;
+      uint8_t bits[0x10000 / 8];
+      for (int kind = 0; kind < KINDS; kind++)
+      {
+         if (!stream.read((char*)bits, sizeof(bits)))
+            return false;
+         for (uint32_t address = 0; address < 0x10000; address++)
+            marks[kind][address] = (bits[address >> 3] >> (address & 7)) & 1;
+      }
+      return true;
+   }
+
+private:
+   uint8_t marks[KINDS][0x10000] = {}; // 0 or 1
+
+   static const char* magic() { return "8080COV1"; }
+
+   template <typename T> static void put(std::ofstream& stream, T value) { stream.write((const char*)&value, sizeof(T)); }
+   template <typename T> static bool get(std::ifstream& stream, T& value) { return (bool)stream.read((char*)&value, sizeof(T)); }
+};
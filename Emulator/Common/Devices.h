@@ -0,0 +1,138 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+
+#include "IOBus.h"
+
+// Space Invaders board devices. Each one attaches itself to the ports it
+// decodes on the real hardware; the port numbers are parameters so other
+// boards can place them elsewhere.
+
+// Hardware bit shift register
+//    OUT offsetPort: shift amount (bits 0,1,2)
+//    OUT dataPort:   shift new byte in from the left
+//    IN  resultPort: 8 bits of the 16 bit register, starting `offset` bits from the top
+class ShiftRegister
+{
+public:
+   void attach(IOBus& bus, uint8_t offsetPort = 2, uint8_t dataPort = 4, uint8_t resultPort = 3)
+   {
+      bus.mapWrite(offsetPort, [](void* self, uint8_t, uint8_t value) {
+         ((ShiftRegister*)self)->offset = value & 0x7;
+      }, this);
+      bus.mapWrite(dataPort, [](void* self, uint8_t, uint8_t value) {
+         ShiftRegister* shifter = (ShiftRegister*)self;
+         shifter->shift0 = shifter->shift1;
+         shifter->shift1 = value;
+      }, this);
+      bus.mapRead(resultPort, [](void* self, uint8_t) -> uint8_t {
+         ShiftRegister* shifter = (ShiftRegister*)self;
+         return ((((shifter->shift1 << 8) | shifter->shift0) >> (8 - shifter->offset)) & 0xff);
+      }, this);
+   }
+
+private:
+   uint8_t offset = 0;
+   uint8_t shift0 = 0;
+   uint8_t shift1 = 0;
+};
+
+// Player inputs and dipswitches, read on ports 1 and 2
+//
+// The state is kept as the finished port bytes so IN is a single load. The
+// bytes are atomics, so input producers on other threads (UI, bot, replay)
+// can set and clear bits lock-free while the CPU is running.
+class InputPorts
+{
+public:
+   // Port 1
+   static const uint8_t COIN          = 1 << 0; // Coin (0 when active)
+   static const uint8_t P2_START      = 1 << 1;
+   static const uint8_t P1_START      = 1 << 2;
+   static const uint8_t P1_SHOOT      = 1 << 4;
+   static const uint8_t P1_LEFT       = 1 << 5;
+   static const uint8_t P1_RIGHT      = 1 << 6;
+   // Port 2
+   static const uint8_t LIVES         = 3 << 0; // Dipswitch number of lives (0:3,1:4,2:5,3:6)
+   static const uint8_t TILT          = 1 << 2; // Tilt 'button'
+   static const uint8_t BONUS_LIFE    = 1 << 3; // Dipswitch bonus life at 1:1000,0:1500
+   static const uint8_t P2_SHOOT      = 1 << 4;
+   static const uint8_t P2_LEFT       = 1 << 5;
+   static const uint8_t P2_RIGHT      = 1 << 6;
+   static const uint8_t COIN_INFO     = 1 << 7; // Dipswitch coin info 1:off,0:on
+
+   static_assert(std::atomic<uint8_t>::is_always_lock_free, "Input ports must be lock-free");
+
+   void attach(IOBus& bus, uint8_t port1 = 1, uint8_t port2 = 2)
+   {
+      bus.mapRead(port1, [](void* self, uint8_t) -> uint8_t {
+         return ((InputPorts*)self)->latch1.load(std::memory_order_relaxed);
+      }, this);
+      bus.mapRead(port2, [](void* self, uint8_t) -> uint8_t {
+         return ((InputPorts*)self)->latch2.load(std::memory_order_relaxed);
+      }, this);
+   }
+
+   // port is 1 or 2; safe to call from any thread
+   void set(int port, uint8_t bits) { byte(port).fetch_or(bits, std::memory_order_relaxed); }
+   void reset(int port, uint8_t bits) { byte(port).fetch_and((uint8_t)~bits, std::memory_order_relaxed); }
+   void assign(int port, uint8_t mask, uint8_t bits) // Replace the bits under mask
+   {
+      std::atomic<uint8_t>& value = byte(port);
+      uint8_t current = value.load(std::memory_order_relaxed);
+      while (!value.compare_exchange_weak(current, (uint8_t)((current & ~mask) | (bits & mask)), std::memory_order_relaxed))
+         ;
+   }
+   uint8_t get(int port) { return byte(port).load(std::memory_order_relaxed); }
+
+private:
+   std::atomic<uint8_t>& byte(int port) { return port == 1 ? latch1 : latch2; }
+
+   std::atomic<uint8_t> latch1{ COIN };
+   std::atomic<uint8_t> latch2{ 3 & LIVES };
+};
+
+// Sound latches on ports 3 and 5. Only remembers what was written; frontends
+// that make noise attach their own device on these ports instead.
+class SoundLatch
+{
+public:
+   void attach(IOBus& bus, uint8_t port3 = 3, uint8_t port5 = 5)
+   {
+      bus.mapWrite(port3, [](void* self, uint8_t, uint8_t value) { ((SoundLatch*)self)->port3 = value; }, this);
+      bus.mapWrite(port5, [](void* self, uint8_t, uint8_t value) { ((SoundLatch*)self)->port5 = value; }, this);
+   }
+
+   uint8_t port3 = 0;
+   uint8_t port5 = 0;
+};
+
+// Watchdog on port 6. The game kicks it all the time (it also writes there
+// while printing text: 0 = a, 1 = b, ...); the emulator never resets on it,
+// but the kicks are counted.
+class Watchdog
+{
+public:
+   void attach(IOBus& bus, uint8_t port = 6)
+   {
+      bus.mapWrite(port, [](void* self, uint8_t, uint8_t value) {
+         Watchdog* watchdog = (Watchdog*)self;
+         watchdog->kicks++;
+         watchdog->last = value;
+      }, this);
+   }
+
+   uint64_t kicks = 0;
+   uint8_t last = 0;
+};
+
+// Not in actual Space Invaders hardware. Debug use only: OUT 0 prints A.
+class DebugConsole
+{
+public:
+   void attach(IOBus& bus, uint8_t port = 0)
+   {
+      bus.mapWrite(port, [](void*, uint8_t, uint8_t value) { std::cout << value; }, nullptr);
+   }
+};
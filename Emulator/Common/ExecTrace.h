@@ -0,0 +1,53 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+#include "Opcodes.h"
+#include "Symbols.h"
+
+// One executed instruction as the execution trace stores it (see
+// MappedRing): the state after the instruction, plus the bytes of the one
+// it leads to, which is everything the old per-instruction debug output
+// printed. Fixed size so the ring can be indexed.
+struct ExecRecord
+{
+   uint64_t cycle;  // Clock after the instruction
+   uint16_t pc;     // Next instruction
+   uint16_t sp;
+   uint16_t atSP;   // Word on top of the stack
+   uint8_t code[3]; // Bytes at pc
+   uint8_t psw;     // S Z 0 AC 0 P 1 CY
+   uint8_t a, b, c, d, e, h, l;
+   uint8_t atDE;    // (DE) and (HL)
+   uint8_t atHL;
+   uint8_t reserved[5];
+};
+static_assert(sizeof(ExecRecord) == 32, "ExecRecord is stored as 32 bytes");
+
+// The old console line for a record:
+// " <pc> <bytes> <mnemonic>PSW=.. A=.. BC=.... (DE=....)=.. (HL=....)=.. (SP=....)=...."
+// Operands are named from `symbols` when given.
+inline void formatExecRecord(const ExecRecord& record, std::string& out, const Symbols* symbols = nullptr)
+{
+   out += ' ';
+   Opcodes::listing(record.pc, record.code, out, Symbols::lookup, (void*)symbols);
+   out += "PSW=";
+   Opcodes::appendHex(out, record.psw, 2);
+   out += " A=";
+   Opcodes::appendHex(out, record.a, 2);
+   out += " BC=";
+   Opcodes::appendHex(out, record.b << 8 | record.c, 4);
+   out += " (DE=";
+   Opcodes::appendHex(out, record.d << 8 | record.e, 4);
+   out += ")=";
+   Opcodes::appendHex(out, record.atDE, 2);
+   out += " (HL=";
+   Opcodes::appendHex(out, record.h << 8 | record.l, 4);
+   out += ")=";
+   Opcodes::appendHex(out, record.atHL, 2);
+   out += " (SP=";
+   Opcodes::appendHex(out, record.sp, 4);
+   out += ")=";
+   if (0x2300 <= record.sp && record.sp < 0x2400) // Only shown inside the stack area
+      Opcodes::appendHex(out, record.atSP, 4);
+}
@@ -0,0 +1,292 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Framebuffer.h"
+
+// Minimal PNG writer: 1 bit grayscale, zlib stream of stored (uncompressed)
+// deflate blocks. A Space Invaders frame is only 7K at 1 bit per pixel, so
+// real compression is not worth a zlib dependency.
+namespace Png
+{
+   inline uint32_t crc32(const uint8_t* data, size_t size, uint32_t crc = 0)
+   {
+      struct Table
+      {
+         uint32_t entries[256];
+         Table()
+         {
+            for (uint32_t n = 0; n < 256; n++)
+            {
+               uint32_t c = n;
+               for (int k = 0; k < 8; k++)
+                  c = c & 1 ? 0xEDB88320 ^ (c >> 1) : c >> 1;
+               entries[n] = c;
+            }
+         }
+      };
+      static const Table table; // Thread-safe initialization
+      crc = ~crc;
+      for (size_t n = 0; n < size; n++)
+         crc = table.entries[(crc ^ data[n]) & 0xff] ^ (crc >> 8);
+      return ~crc;
+   }
+
+   inline uint32_t adler32(const uint8_t* data, size_t size)
+   {
+      uint32_t a = 1, b = 0;
+      for (size_t n = 0; n < size; n++)
+      {
+         a = (a + data[n]) % 65521;
+         b = (b + a) % 65521;
+      }
+      return b << 16 | a;
+   }
+
+   inline void put32(std::vector<uint8_t>& out, uint32_t value)
+   {
+      for (int shift = 24; shift >= 0; shift -= 8)
+         out.push_back((uint8_t)(value >> shift));
+   }
+
+   inline void chunk(std::vector<uint8_t>& out, const char* type, const std::vector<uint8_t>& data)
+   {
+      put32(out, (uint32_t)data.size());
+      size_t start = out.size();
+      out.insert(out.end(), type, type + 4);
+      out.insert(out.end(), data.begin(), data.end());
+      put32(out, crc32(&out[start], out.size() - start));
+   }
+
+   // `rows` is height rows of (width + 7) / 8 bytes, leftmost pixel in bit 7
+   inline void encodeGray1(const uint8_t* rows, int width, int height, std::vector<uint8_t>& out)
+   {
+      static const uint8_t signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+      out.assign(signature, signature + 8);
+
+      std::vector<uint8_t> header;
+      put32(header, width);
+      put32(header, height);
+      header.insert(header.end(), { 1, 0, 0, 0, 0 }); // Depth 1, grayscale, deflate, adaptive filters, no interlace
+      chunk(out, "IHDR", header);
+
+      size_t stride = (width + 7) / 8;
+      std::vector<uint8_t> raw;
+      raw.reserve((stride + 1) * height);
+      for (int row = 0; row < height; row++)
+      {
+         raw.push_back(0); // Filter: none
+         raw.insert(raw.end(), rows + row * stride, rows + (row + 1) * stride);
+      }
+
+      std::vector<uint8_t> zlib = { 0x78, 0x01 };
+      for (size_t offset = 0; offset == 0 || offset < raw.size(); offset += 65535)
+      {
+         size_t length = std::min<size_t>(65535, raw.size() - offset);
+         zlib.push_back(offset + length == raw.size() ? 1 : 0); // BFINAL, stored
+         zlib.insert(zlib.end(), { (uint8_t)length, (uint8_t)(length >> 8), (uint8_t)~length, (uint8_t)(~length >> 8) });
+         zlib.insert(zlib.end(), raw.begin() + offset, raw.begin() + offset + length);
+      }
+      put32(zlib, adler32(raw.data(), raw.size()));
+      chunk(out, "IDAT", zlib);
+      chunk(out, "IEND", {});
+   }
+}
+
+// Records finished frames (the 0x1c00 bytes of VRAM at 0x2400) to disk on a
+// pool of worker threads.
+//
+//    Y4M: one YUV4MPEG2 stream, 224x256 Cmono at 60 fps (ffmpeg/mpv read it)
+//    RAW: the same 8 bit gray frames with no headers
+//    PNG: <path><frame number, 6 digits>.png, 1 bit grayscale
+//
+// submit() copies the frame into a bounded queue and returns; it only
+// blocks when `limit` frames are still waiting to be encoded or written,
+// i.e. when the disk (or the encoders) fall behind. Stream formats are
+// written in frame order by a writer thread however the workers finish.
+class FrameCapture
+{
+public:
+   enum Format { Y4M, RAW, PNG };
+
+   static bool parseFormat(const std::string& name, Format& format)
+   {
+      if (name == "y4m") format = Y4M;
+      else if (name == "raw") format = RAW;
+      else if (name == "png") format = PNG;
+      else return false;
+      return true;
+   }
+
+   FrameCapture(const std::string& path, Format format, int threads = 0, size_t limit = 64)
+      : path(path), format(format), limit(limit)
+   {
+      if (format != PNG)
+      {
+         stream.open(path, std::ios::binary);
+         if (!stream)
+            throw std::string("Can't write ") + path;
+         if (format == Y4M)
+            stream << "YUV4MPEG2 W" << Framebuffer::WIDTH << " H" << Framebuffer::HEIGHT << " F60:1 Ip A1:1 Cmono\n";
+         writer = std::thread(&FrameCapture::write, this);
+      }
+
+      if (threads <= 0)
+         threads = std::max(1, (int)std::thread::hardware_concurrency() - 1); // Leave one for the emulator
+      for (int n = 0; n < threads; n++)
+         workers.emplace_back(&FrameCapture::work, this);
+      start = std::chrono::steady_clock::now();
+   }
+   ~FrameCapture() { finish(); }
+
+   void submit(const uint8_t* vram)
+   {
+      std::unique_lock<std::mutex> lock(mutex);
+      if (inFlight >= limit)
+      {
+         auto blockedAt = std::chrono::steady_clock::now();
+         spaceFree.wait(lock, [this] { return inFlight < limit; });
+         blocked += std::chrono::steady_clock::now() - blockedAt;
+         stalls++;
+      }
+      inFlight++;
+      queue.push_back({ submitted++, std::vector<uint8_t>(vram, vram + 0x1c00) });
+      workReady.notify_one();
+   }
+
+   // Encodes and writes everything submitted, then stops the threads
+   void finish()
+   {
+      {
+         std::lock_guard<std::mutex> lock(mutex);
+         if (stopping)
+            return;
+         stopping = true;
+      }
+      workReady.notify_all();
+      for (std::thread& worker : workers)
+         worker.join();
+      doneReady.notify_all();
+      if (writer.joinable())
+         writer.join();
+      stream.close();
+      elapsed = std::chrono::steady_clock::now() - start;
+   }
+
+   void report(std::ostream& out)
+   {
+      double seconds = std::chrono::duration<double>(elapsed).count();
+      out << "Captured " << written << " frames in " << seconds << " s ("
+         << (seconds > 0 ? written / seconds : 0) << " fps encoded, " << workers.size() << " workers); emulation blocked "
+         << std::chrono::duration<double>(blocked).count() << " s in " << stalls << " stalls" << std::endl;
+   }
+
+private:
+   struct Job
+   {
+      uint64_t number;
+      std::vector<uint8_t> vram;
+   };
+
+   void work()
+   {
+      std::vector<uint8_t> packed(Framebuffer::WIDTH / 8 * Framebuffer::HEIGHT);
+      for (;;)
+      {
+         Job job;
+         {
+            std::unique_lock<std::mutex> lock(mutex);
+            workReady.wait(lock, [this] { return stopping || !queue.empty(); });
+            if (queue.empty())
+               return;
+            job = std::move(queue.front());
+            queue.pop_front();
+         }
+
+         Framebuffer::convertPacked(job.vram.data(), packed.data(), Framebuffer::WIDTH / 8);
+         std::vector<uint8_t> encoded;
+         if (format == PNG)
+         {
+            Png::encodeGray1(packed.data(), Framebuffer::WIDTH, Framebuffer::HEIGHT, encoded);
+            char number[16];
+            std::snprintf(number, sizeof(number), "%06llu", (unsigned long long)job.number);
+            std::ofstream file(path + number + ".png", std::ios::binary);
+            file.write((const char*)encoded.data(), encoded.size());
+
+            std::lock_guard<std::mutex> lock(mutex);
+            written++;
+            inFlight--;
+            spaceFree.notify_one();
+            continue;
+         }
+
+         if (format == Y4M)
+            encoded.assign({ 'F', 'R', 'A', 'M', 'E', '\n' });
+         size_t header = encoded.size();
+         encoded.resize(header + Framebuffer::WIDTH * Framebuffer::HEIGHT);
+         for (size_t pixel = 0; pixel < Framebuffer::WIDTH * Framebuffer::HEIGHT; pixel++)
+            encoded[header + pixel] = packed[pixel / 8] & (0x80 >> pixel % 8) ? 0xff : 0x00;
+
+         std::lock_guard<std::mutex> lock(mutex);
+         done[job.number] = std::move(encoded);
+         doneReady.notify_one();
+      }
+   }
+
+   // Stream formats: writes encoded frames in order
+   void write()
+   {
+      for (;;)
+      {
+         std::vector<uint8_t> data;
+         {
+            std::unique_lock<std::mutex> lock(mutex);
+            doneReady.wait(lock, [this] { return done.count(written) || (stopping && written == submitted); });
+            if (!done.count(written))
+               return;
+            data = std::move(done[written]);
+            done.erase(written);
+         }
+         stream.write((const char*)data.data(), data.size());
+
+         std::lock_guard<std::mutex> lock(mutex);
+         written++;
+         inFlight--;
+         spaceFree.notify_one();
+      }
+   }
+
+   std::string path;
+   Format format;
+   size_t limit;
+   std::ofstream stream;
+
+   std::mutex mutex;
+   std::condition_variable workReady, doneReady, spaceFree;
+   std::deque<Job> queue;
+   std::map<uint64_t, std::vector<uint8_t>> done; // Encoded, waiting for their turn to be written
+   size_t inFlight = 0;                           // Submitted and not yet written
+   uint64_t submitted = 0;
+   uint64_t written = 0;
+   bool stopping = false;
+
+   std::vector<std::thread> workers;
+   std::thread writer;
+
+   std::chrono::steady_clock::time_point start;
+   std::chrono::steady_clock::duration elapsed{ 0 };
+   std::chrono::steady_clock::duration blocked{ 0 };
+   uint64_t stalls = 0;
+};
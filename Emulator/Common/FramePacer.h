@@ -0,0 +1,134 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <ostream>
+#include <thread>
+
+// Paces a loop to a fixed period on steady_clock.
+//
+// Deadlines are absolute (start + n * period), so rounding and oversleeping
+// never accumulate into drift. Each wait sleeps until a margin before the
+// deadline and spins the rest; the margin follows how badly the OS has been
+// oversleeping. A loop that falls more than RESYNC behind starts a new
+// schedule instead of running a burst of frames to catch up.
+//
+// Optionally follows a reference clock (seconds, e.g. samples consumed by
+// the audio device): the schedule is nudged a little each frame toward it,
+// so over minutes the loop runs at the reference's rate, not the CPU
+// crystal's.
+//
+// Wake-up error (actual - deadline) is kept in a histogram for report().
+class FramePacer
+{
+public:
+   typedef std::chrono::steady_clock Clock;
+   typedef double (*ReferenceClock)(void* context);
+
+   static const int BUCKETS = 8;
+
+   FramePacer(std::chrono::nanoseconds period) : period(period) { restart(); }
+
+   void setReference(ReferenceClock clock, void* context)
+   {
+      reference = clock;
+      referenceContext = context;
+      restart();
+   }
+
+   // Starts a new schedule with the next deadline one period from now
+   void restart()
+   {
+      start = Clock::now();
+      frames = 0;
+      correction = std::chrono::nanoseconds(0);
+      if (reference)
+         referenceStart = reference(referenceContext);
+   }
+
+   // Blocks until the next deadline
+   void wait()
+   {
+      frames++;
+      if (reference)
+         follow();
+      Clock::time_point deadline = start + period * (int64_t)frames - correction;
+
+      Clock::time_point now = Clock::now();
+      if (now - deadline > RESYNC)
+      {
+         resyncs++;
+         restart();
+         return;
+      }
+
+      Clock::time_point wake = deadline - spinMargin;
+      if (wake > now)
+      {
+         std::this_thread::sleep_until(wake);
+         // Keep the margin a bit above the oversleep we actually get
+         std::chrono::nanoseconds oversleep = Clock::now() - wake;
+         spinMargin = std::max(MIN_SPIN, std::min(MAX_SPIN, (spinMargin * 7 + oversleep * 3 / 2 + MIN_SPIN) / 8));
+      }
+      while ((now = Clock::now()) < deadline)
+         std::this_thread::yield();
+
+      record(now - deadline);
+   }
+
+   void report(std::ostream& stream, const char* name)
+   {
+      static const char* const labels[BUCKETS] = { "<50us", "<100us", "<250us", "<500us", "<1ms", "<2ms", "<4ms", ">=4ms" };
+      uint64_t total = 0;
+      for (uint64_t count : histogram)
+         total += count;
+      stream << name << " frame time error over " << total << " frames"
+         << " (worst " << std::chrono::duration_cast<std::chrono::microseconds>(worst).count() << "us, "
+         << resyncs << " resyncs)" << std::endl;
+      for (int bucket = 0; bucket < BUCKETS; bucket++)
+         stream << "  " << std::setw(6) << labels[bucket] << " " << std::setw(8) << histogram[bucket]
+            << std::fixed << std::setprecision(2) << std::setw(8) << (total ? 100.0 * histogram[bucket] / total : 0) << "%" << std::endl;
+   }
+
+private:
+   static constexpr std::chrono::nanoseconds RESYNC = std::chrono::milliseconds(250);
+   static constexpr std::chrono::nanoseconds MIN_SPIN = std::chrono::microseconds(200);
+   static constexpr std::chrono::nanoseconds MAX_SPIN = std::chrono::milliseconds(4);
+   static constexpr std::chrono::nanoseconds MAX_NUDGE = std::chrono::microseconds(100); // Per frame
+
+   // Moves the schedule a fraction of the way toward the reference clock
+   void follow()
+   {
+      double referenceTime = reference(referenceContext) - referenceStart;
+      std::chrono::nanoseconds scheduled = period * (int64_t)frames - correction;
+      std::chrono::nanoseconds drift((int64_t)(referenceTime * 1e9) - scheduled.count()); // > 0: reference is ahead
+      std::chrono::nanoseconds nudge = std::max(-MAX_NUDGE, std::min(MAX_NUDGE, drift / 32));
+      correction += nudge;
+   }
+
+   void record(std::chrono::nanoseconds error)
+   {
+      static const int64_t edges[BUCKETS - 1] = { 50, 100, 250, 500, 1000, 2000, 4000 };
+      int64_t us = std::chrono::duration_cast<std::chrono::microseconds>(error).count();
+      int bucket = 0;
+      while (bucket < BUCKETS - 1 && us >= edges[bucket])
+         bucket++;
+      histogram[bucket]++;
+      worst = std::max(worst, error);
+   }
+
+   std::chrono::nanoseconds period;
+   Clock::time_point start;
+   uint64_t frames = 0;
+   std::chrono::nanoseconds spinMargin = std::chrono::milliseconds(2);
+
+   ReferenceClock reference = nullptr;
+   void* referenceContext = nullptr;
+   double referenceStart = 0;
+   std::chrono::nanoseconds correction{ 0 }; // Subtracted from the schedule to follow the reference
+
+   uint64_t histogram[BUCKETS] = {};
+   std::chrono::nanoseconds worst{ 0 };
+   uint64_t resyncs = 0;
+};
@@ -0,0 +1,124 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+
+// Space Invaders video RAM to 32 bit pixels.
+//
+// VRAM is 224 lines of 32 bytes, 1 bit per pixel, scanned with the monitor
+// turned 90 degrees: VRAM line n is screen column n, and its first byte is
+// the bottom of the screen with the lowest bit lowest. So screen pixel
+// (row, col) is bit 7 - row % 8 of byte 32 * col + 31 - row / 8.
+//
+// Pixels are 0xFFFFFFFF (on) or 0xFF000000 (off) as uint32_t, which is
+// white/black with opaque alpha in SDL_PIXELFORMAT_ABGR8888 on little endian.
+// `pitch` is the distance between output rows in bytes.
+namespace Framebuffer
+{
+   const int WIDTH = 224;
+   const int HEIGHT = 256;
+   const uint16_t VRAM = 0x2400; // Offset of VRAM in the 8080 address space
+   const uint32_t ON = 0xFFFFFFFF;
+   const uint32_t OFF = 0xFF000000;
+
+   inline uint32_t* row(uint32_t* out, int pitch, int row) { return (uint32_t*)((uint8_t*)out + (intptr_t)row * pitch); }
+
+   // One pixel at a time, the way SpaceInvaders::draw always did it. Kept as
+   // the reference the fast path is checked against.
+   inline void convertReference(const uint8_t* vram, uint32_t* out, int pitch)
+   {
+      for (int r = 0; r < HEIGHT; r++)
+         for (int col = 0; col < WIDTH; col++)
+         {
+            uint8_t byte = vram[HEIGHT / 8 * col + (0x1F - r / 8)];
+            uint8_t pixel = byte & (1 << (7 - r % 8));
+            row(out, pitch, r)[col] = pixel ? ON : OFF;
+         }
+   }
+
+   // Transposes an 8x8 bit matrix held one row per byte: bit j of byte i
+   // moves to bit i of byte j (Hacker's Delight, transpose8)
+   inline uint64_t transpose8x8(uint64_t x)
+   {
+      uint64_t t;
+      t = (x ^ (x >> 7)) & 0x00AA00AA00AA00AAull;  x ^= t ^ (t << 7);
+      t = (x ^ (x >> 14)) & 0x0000CCCC0000CCCCull; x ^= t ^ (t << 14);
+      t = (x ^ (x >> 28)) & 0x00000000F0F0F0F0ull; x ^= t ^ (t << 28);
+      return x;
+   }
+
+   // The 8 pixels of every byte value, 8K built on first use. Measured
+   // faster than building them with SSE2 compares (Tools/FramebufferBench).
+   struct ExpandTable
+   {
+      uint32_t pixels[256][8];
+
+      ExpandTable()
+      {
+         for (int bits = 0; bits < 256; bits++)
+            for (int n = 0; n < 8; n++)
+               pixels[bits][n] = (bits >> n) & 1 ? ON : OFF;
+      }
+   };
+   inline const ExpandTable& expandTable()
+   {
+      static const ExpandTable TABLE;
+      return TABLE;
+   }
+
+   // 8 pixels from one byte, bit 0 leftmost
+   inline void expand8(uint8_t bits, uint32_t* out)
+   {
+      std::memcpy(out, expandTable().pixels[bits], sizeof(uint32_t) * 8);
+   }
+
+   // Converts VRAM lines [firstLine, lastLine) (screen columns; multiples
+   // of 8) in 8x8 blocks: gather one byte from each of 8 lines, transpose so
+   // each byte is 8 horizontal pixels of one screen row, expand.
+   inline void convert(const uint8_t* vram, uint32_t* out, int pitch, int firstLine = 0, int lastLine = WIDTH)
+   {
+      for (int line = firstLine; line < lastLine; line += 8)
+      {
+         const uint8_t* block = vram + 32 * line;
+         for (int k = 0; k < 32; k++)
+         {
+            uint64_t x = 0;
+            for (int i = 0; i < 8; i++)
+               x |= (uint64_t)block[32 * i + k] << (8 * i);
+            x = transpose8x8(x); // Byte b: bit b of each line
+
+            int top = (31 - k) * 8; // Bit 7 of byte k is the top row of its 8
+            for (int j = 0; j < 8; j++)
+               expand8((uint8_t)(x >> (8 * (7 - j))), row(out, pitch, top + j) + line);
+         }
+      }
+   }
+
+   // Reverses the bits of a byte
+   inline uint8_t reverse8(uint8_t b)
+   {
+      b = (uint8_t)((b & 0xF0) >> 4 | (b & 0x0F) << 4);
+      b = (uint8_t)((b & 0xCC) >> 2 | (b & 0x33) << 2);
+      return (uint8_t)((b & 0xAA) >> 1 | (b & 0x55) << 1);
+   }
+
+   // Same transpose, packed 1 bit per pixel for image encoders: WIDTH / 8
+   // bytes per row (rows `pitch` bytes apart), leftmost pixel in bit 7, 1 = on
+   inline void convertPacked(const uint8_t* vram, uint8_t* out, int pitch)
+   {
+      for (int line = 0; line < WIDTH; line += 8)
+      {
+         const uint8_t* block = vram + 32 * line;
+         for (int k = 0; k < 32; k++)
+         {
+            uint64_t x = 0;
+            for (int i = 0; i < 8; i++)
+               x |= (uint64_t)block[32 * i + k] << (8 * i);
+            x = transpose8x8(x);
+
+            int top = (31 - k) * 8;
+            for (int j = 0; j < 8; j++)
+               out[(top + j) * pitch + line / 8] = reverse8((uint8_t)(x >> (8 * (7 - j))));
+         }
+      }
+   }
+}
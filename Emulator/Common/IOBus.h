@@ -0,0 +1,39 @@
+#pragma once
+#include <cstdint>
+
+// 256 entry I/O port dispatch table
+//
+// Every IN/OUT port has one handler (function pointer plus the context it is
+// called with). Devices register themselves on the ports they decode, so a
+// board is just a list of attach() calls and IN/OUT cost one indirect call.
+// Unmapped ports read as 0 and ignore writes.
+class IOBus
+{
+public:
+   typedef uint8_t(*ReadHandler)(void* context, uint8_t port);
+   typedef void(*WriteHandler)(void* context, uint8_t port, uint8_t value);
+
+   IOBus()
+   {
+      for (int port = 0; port < 256; port++)
+      {
+         in[port] = { unmappedRead, nullptr };
+         out[port] = { unmappedWrite, nullptr };
+      }
+   }
+
+   void mapRead(uint8_t port, ReadHandler handler, void* context) { in[port] = { handler, context }; }
+   void mapWrite(uint8_t port, WriteHandler handler, void* context) { out[port] = { handler, context }; }
+   void unmapRead(uint8_t port) { in[port] = { unmappedRead, nullptr }; }
+   void unmapWrite(uint8_t port) { out[port] = { unmappedWrite, nullptr }; }
+
+   uint8_t read(uint8_t port) { return in[port].handler(in[port].context, port); }
+   void write(uint8_t port, uint8_t value) { out[port].handler(out[port].context, port, value); }
+
+private:
+   struct InPort { ReadHandler handler; void* context; } in[256];
+   struct OutPort { WriteHandler handler; void* context; } out[256];
+
+   static uint8_t unmappedRead(void*, uint8_t) { return 0; }
+   static void unmappedWrite(void*, uint8_t, uint8_t) {}
+};
@@ -0,0 +1,352 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <ostream>
+#include <string>
+
+#include "Opcodes.h"
+
+// Counters kept while the CPU runs, for profiling and for watching long
+// sessions: per opcode counts and cycles, interrupts taken and how long
+// they waited, HLT, I/O ports, memory by 256 byte page and host time per
+// frame.
+//
+// The CPU, memory and run loop call the hooks below; defining
+// NO_INSTRUMENTATION compiles their bodies out. Counters is plain data of
+// 64 bit counts only, so a snapshot is a copy and the difference of two
+// snapshots is the activity in between. writeJson and writeCsv export one.
+struct Counters
+{
+   static const int BUCKETS = 10;
+
+   uint64_t cycles;              // Halted ones too. Both totals are filled in by snapshot.
+   uint64_t instructions;
+   uint64_t opcodeCount[256];
+   uint64_t opcodeCycles[256];   // As returned: taken or not for conditional CALL/RET
+   uint64_t interrupts[8];       // Taken, by RST number
+   uint64_t interruptLatency;    // Cycles from the request to taking it, summed
+   uint64_t latencyHistogram[BUCKETS];
+   uint64_t haltCycles;          // Cycles spent halted, after opcodeCount[0x76] HLTs
+   uint64_t portReads[256];
+   uint64_t portWrites[256];
+   uint64_t pageReads[256];      // Data reads by address >> 8
+   uint64_t pageWrites[256];
+   uint64_t pageFetches[256];    // Instruction bytes
+   uint64_t frames;
+   uint64_t frameNanoseconds;    // Host time from one frame hook to the next
+   uint64_t frameHistogram[BUCKETS];
+
+   // Interrupt latency in cycles, frame time in microseconds: bucket n
+   // counts values below LIMITS[n], the last one everything above
+   static const uint64_t* latencyLimits()
+   {
+      static const uint64_t LIMITS[BUCKETS - 1] = { 8, 16, 32, 64, 128, 256, 512, 1024, 4096 };
+      return LIMITS;
+   }
+   static const uint64_t* frameLimits()
+   {
+      static const uint64_t LIMITS[BUCKETS - 1] = { 250, 500, 1000, 2000, 4000, 8000, 16667, 33333, 66667 };
+      return LIMITS;
+   }
+
+   // Activity between an earlier snapshot and this one
+   Counters operator-(const Counters& earlier) const
+   {
+      Counters difference;
+      const uint64_t* a = (const uint64_t*)this;
+      const uint64_t* b = (const uint64_t*)&earlier;
+      uint64_t* out = (uint64_t*)&difference;
+      for (size_t n = 0; n < sizeof(Counters) / sizeof(uint64_t); n++)
+         out[n] = a[n] - b[n];
+      return difference;
+   }
+};
+static_assert(sizeof(Counters) % sizeof(uint64_t) == 0, "Counters is 64 bit counts only");
+
+class Instrumentation
+{
+public:
+   Instrumentation() { std::memset(&counters, 0, sizeof(counters)); }
+
+   // Hooks
+   void instruction(uint8_t opcode, int cycles)
+   {
+#ifndef NO_INSTRUMENTATION
+      counters.opcodeCount[opcode]++;
+      counters.opcodeCycles[opcode] += cycles;
+#endif
+   }
+
+   void interruptRequested()
+   {
+#ifndef NO_INSTRUMENTATION
+      if (!pending) // A later request replaces the opcode, not the wait
+         requestedAt = totalCycles();
+      pending = true;
+#endif
+   }
+
+   void interruptTaken(uint8_t opcode)
+   {
+#ifndef NO_INSTRUMENTATION
+      counters.interrupts[(opcode >> 3) & 7]++;
+      uint64_t latency = totalCycles() - requestedAt;
+      counters.interruptLatency += latency;
+      counters.latencyHistogram[bucket(latency, Counters::latencyLimits())]++;
+      pending = false;
+#endif
+   }
+
+   void halted(int cycles)
+   {
+#ifndef NO_INSTRUMENTATION
+      counters.haltCycles += cycles;
+#endif
+   }
+
+   void portRead(uint8_t port)
+   {
+#ifndef NO_INSTRUMENTATION
+      counters.portReads[port]++;
+#endif
+   }
+
+   void portWrite(uint8_t port)
+   {
+#ifndef NO_INSTRUMENTATION
+      counters.portWrites[port]++;
+#endif
+   }
+
+   void memoryRead(uint16_t address)
+   {
+#ifndef NO_INSTRUMENTATION
+      counters.pageReads[address >> 8]++;
+#endif
+   }
+
+   void memoryWrite(uint16_t address)
+   {
+#ifndef NO_INSTRUMENTATION
+      counters.pageWrites[address >> 8]++;
+#endif
+   }
+
+   void memoryFetch(uint16_t address)
+   {
+#ifndef NO_INSTRUMENTATION
+      counters.pageFetches[address >> 8]++;
+#endif
+   }
+
+   // Once per emulated frame; the first call only starts the clock
+   void frame()
+   {
+#ifndef NO_INSTRUMENTATION
+      std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+      if (frameStarted)
+      {
+         uint64_t nanoseconds = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(now - lastFrame).count();
+         counters.frames++;
+         counters.frameNanoseconds += nanoseconds;
+         counters.frameHistogram[bucket(nanoseconds / 1000, Counters::frameLimits())]++;
+      }
+      lastFrame = now;
+      frameStarted = true;
+#endif
+   }
+
+   static bool isEnabled()
+   {
+#ifndef NO_INSTRUMENTATION
+      return true;
+#else
+      return false;
+#endif
+   }
+
+   // The emulated side of the counters, for emulators that roll the CPU
+   // back (run-ahead): restoring one forgets the work done since it was
+   // saved. Host frame times are not emulated and are left out.
+   struct Snapshot
+   {
+      Counters counters;
+      uint64_t requestedAt;
+      bool pending;
+   };
+   void save(Snapshot& snapshot) const
+   {
+      snapshot.counters = counters;
+      snapshot.requestedAt = requestedAt;
+      snapshot.pending = pending;
+   }
+   void restore(const Snapshot& snapshot)
+   {
+      uint64_t frames = counters.frames, frameNanoseconds = counters.frameNanoseconds;
+      uint64_t frameHistogram[Counters::BUCKETS];
+      std::memcpy(frameHistogram, counters.frameHistogram, sizeof(frameHistogram));
+      counters = snapshot.counters;
+      counters.frames = frames;
+      counters.frameNanoseconds = frameNanoseconds;
+      std::memcpy(counters.frameHistogram, frameHistogram, sizeof(frameHistogram));
+      requestedAt = snapshot.requestedAt;
+      pending = snapshot.pending;
+   }
+
+   // The totals are worked out here from the per opcode counts rather than
+   // kept on every instruction
+   Counters snapshot() const
+   {
+      Counters copy = counters;
+      copy.cycles = totalCycles();
+      copy.instructions = 0;
+      for (uint64_t count : counters.opcodeCount)
+         copy.instructions += count;
+      return copy;
+   }
+
+   // One line of JSON: {"sample":"...","cycles":...,"opcodes":[...],...}.
+   // Opcodes, ports and pages that were never used are left out.
+   static void writeJson(std::ostream& stream, const Counters& counters, const std::string& sample)
+   {
+      stream << "{\"sample\":\"" << sample << "\",\"cycles\":" << counters.cycles << ",\"instructions\":" << counters.instructions;
+      stream << ",\"opcodes\":[";
+      const char* separator = "";
+      for (int opcode = 0; opcode < 256; opcode++)
+         if (counters.opcodeCount[opcode])
+         {
+            stream << separator << "{\"opcode\":" << opcode << ",\"mnemonic\":\"" << mnemonic(opcode) << "\",\"count\":"
+               << counters.opcodeCount[opcode] << ",\"cycles\":" << counters.opcodeCycles[opcode] << "}";
+            separator = ",";
+         }
+      stream << "],\"interrupts\":{\"taken\":[";
+      for (int n = 0; n < 8; n++)
+         stream << (n ? "," : "") << counters.interrupts[n];
+      stream << "],\"latencyCycles\":" << counters.interruptLatency << ",\"latencyHistogram\":";
+      writeJsonArray(stream, counters.latencyHistogram, Counters::BUCKETS);
+      stream << ",\"latencyLimits\":";
+      writeJsonArray(stream, Counters::latencyLimits(), Counters::BUCKETS - 1);
+      stream << "},\"halt\":{\"count\":" << counters.opcodeCount[HLT] << ",\"cycles\":" << counters.haltCycles << "}";
+      stream << ",\"ports\":[";
+      separator = "";
+      for (int port = 0; port < 256; port++)
+         if (counters.portReads[port] || counters.portWrites[port])
+         {
+            stream << separator << "{\"port\":" << port << ",\"reads\":" << counters.portReads[port] << ",\"writes\":" << counters.portWrites[port] << "}";
+            separator = ",";
+         }
+      stream << "],\"pages\":[";
+      separator = "";
+      for (int page = 0; page < 256; page++)
+         if (counters.pageReads[page] || counters.pageWrites[page] || counters.pageFetches[page])
+         {
+            stream << separator << "{\"page\":" << page << ",\"reads\":" << counters.pageReads[page] << ",\"writes\":" << counters.pageWrites[page]
+               << ",\"fetches\":" << counters.pageFetches[page] << "}";
+            separator = ",";
+         }
+      stream << "],\"frames\":{\"count\":" << counters.frames << ",\"nanoseconds\":" << counters.frameNanoseconds << ",\"histogram\":";
+      writeJsonArray(stream, counters.frameHistogram, Counters::BUCKETS);
+      stream << ",\"limitsMicroseconds\":";
+      writeJsonArray(stream, Counters::frameLimits(), Counters::BUCKETS - 1);
+      stream << "}}" << std::endl;
+   }
+
+   // "sample,counter,index,value" rows, one per nonzero count; `header`
+   // writes the column names first
+   static void writeCsv(std::ostream& stream, const Counters& counters, const std::string& sample, bool header)
+   {
+      if (header)
+         stream << "sample,counter,index,value\n";
+      auto row = [&](const char* counter, int index, uint64_t value) {
+         if (value)
+            stream << sample << "," << counter << "," << index << "," << value << "\n";
+      };
+      row("cycles", 0, counters.cycles);
+      row("instructions", 0, counters.instructions);
+      for (int n = 0; n < 256; n++)
+         row("opcode_count", n, counters.opcodeCount[n]);
+      for (int n = 0; n < 256; n++)
+         row("opcode_cycles", n, counters.opcodeCycles[n]);
+      for (int n = 0; n < 8; n++)
+         row("interrupts", n, counters.interrupts[n]);
+      row("interrupt_latency_cycles", 0, counters.interruptLatency);
+      for (int n = 0; n < Counters::BUCKETS; n++)
+         row("interrupt_latency_histogram", n, counters.latencyHistogram[n]);
+      row("halts", 0, counters.opcodeCount[HLT]);
+      row("halt_cycles", 0, counters.haltCycles);
+      for (int n = 0; n < 256; n++)
+         row("port_reads", n, counters.portReads[n]);
+      for (int n = 0; n < 256; n++)
+         row("port_writes", n, counters.portWrites[n]);
+      for (int n = 0; n < 256; n++)
+         row("page_reads", n, counters.pageReads[n]);
+      for (int n = 0; n < 256; n++)
+         row("page_writes", n, counters.pageWrites[n]);
+      for (int n = 0; n < 256; n++)
+         row("page_fetches", n, counters.pageFetches[n]);
+      row("frames", 0, counters.frames);
+      row("frame_nanoseconds", 0, counters.frameNanoseconds);
+      for (int n = 0; n < Counters::BUCKETS; n++)
+         row("frame_histogram", n, counters.frameHistogram[n]);
+      stream.flush();
+   }
+
+   // A few lines for people: totals, interrupts and frame times
+   static void writeSummary(std::ostream& stream, const Counters& counters)
+   {
+      uint64_t taken = 0;
+      for (uint64_t count : counters.interrupts)
+         taken += count;
+      stream << std::dec << counters.instructions << " instructions, " << counters.cycles << " cycles, "
+         << taken << " interrupts (" << std::fixed << std::setprecision(1) << (taken ? (double)counters.interruptLatency / taken : 0.0)
+         << " cycles average wait), " << counters.opcodeCount[HLT] << " HLT (" << counters.haltCycles << " cycles)" << std::endl;
+      if (counters.frames)
+         stream << counters.frames << " frames, " << std::setprecision(3) << counters.frameNanoseconds / 1e6 / counters.frames
+            << " ms average host time" << std::endl;
+   }
+
+private:
+   static const int HLT = 0x76;
+
+   Counters counters;
+   uint64_t requestedAt = 0;
+   bool pending = false;
+   std::chrono::steady_clock::time_point lastFrame;
+   bool frameStarted = false;
+
+   uint64_t totalCycles() const
+   {
+      uint64_t total = counters.haltCycles;
+      for (uint64_t cycles : counters.opcodeCycles)
+         total += cycles;
+      return total;
+   }
+
+   static int bucket(uint64_t value, const uint64_t* limits)
+   {
+      int n = 0;
+      while (n < Counters::BUCKETS - 1 && value >= limits[n])
+         n++;
+      return n;
+   }
+
+   static void writeJsonArray(std::ostream& stream, const uint64_t* values, int count)
+   {
+      stream << "[";
+      for (int n = 0; n < count; n++)
+         stream << (n ? "," : "") << values[n];
+      stream << "]";
+   }
+
+   // "LD A,#" for "LD     A,#"
+   static std::string mnemonic(int opcode)
+   {
+      std::string text;
+      for (const char* c = Opcodes::TABLE[opcode].mnemonic; c && *c; c++)
+         if (*c != ' ' || (!text.empty() && text.back() != ' '))
+            text += *c;
+      return text;
+   }
+};
@@ -0,0 +1,120 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// Small LZ77 block codec using the LZ4 sequence layout:
+//
+//    token | [literal length bytes] | literals | offset (LE16) | [match length bytes]
+//
+// The high nibble of the token is the literal count, the low nibble the match
+// length minus 4. A nibble of 15 continues in following bytes (255 means keep
+// adding). The last sequence of a block carries literals only. Speed matters
+// more than ratio here, so the match finder is a single-probe hash table.
+namespace LZBlock
+{
+   const int MIN_MATCH = 4;
+   const int HASH_BITS = 12;
+   const size_t MAX_OFFSET = 0xffff;
+
+   inline uint32_t read32(const uint8_t* p) { uint32_t v; std::memcpy(&v, p, 4); return v; }
+   inline uint32_t hash(uint32_t v) { return (v * 2654435761u) >> (32 - HASH_BITS); }
+
+   inline void writeLength(std::vector<uint8_t>& out, size_t length)
+   {
+      for (; length >= 255; length -= 255)
+         out.push_back(255);
+      out.push_back((uint8_t)length);
+   }
+
+   inline void emit(std::vector<uint8_t>& out, const uint8_t* literals, size_t literalCount, size_t offset, size_t matchLength)
+   {
+      size_t match = matchLength ? matchLength - MIN_MATCH : 0;
+      out.push_back((uint8_t)(((literalCount < 15 ? literalCount : 15) << 4) | (match < 15 ? match : 15)));
+      if (literalCount >= 15)
+         writeLength(out, literalCount - 15);
+      out.insert(out.end(), literals, literals + literalCount);
+      if (matchLength == 0)
+         return; // Final sequence
+      out.push_back((uint8_t)(offset >> 0));
+      out.push_back((uint8_t)(offset >> 8));
+      if (match >= 15)
+         writeLength(out, match - 15);
+   }
+
+   // Appends the compressed form of src to out
+   inline void compress(const uint8_t* src, size_t size, std::vector<uint8_t>& out)
+   {
+      std::vector<uint32_t> table(1 << HASH_BITS, 0); // Position + 1 of last occurrence, 0 = none
+      size_t anchor = 0; // Start of pending literals
+      size_t pos = 0;
+
+      while (pos + MIN_MATCH <= size)
+      {
+         uint32_t sequence = read32(src + pos);
+         uint32_t& slot = table[hash(sequence)];
+         size_t candidate = slot;
+         slot = (uint32_t)(pos + 1);
+
+         if (candidate == 0 || pos - (candidate - 1) > MAX_OFFSET || read32(src + candidate - 1) != sequence)
+         {
+            pos++;
+            continue;
+         }
+         candidate--;
+
+         size_t length = MIN_MATCH;
+         while (pos + length < size && src[candidate + length] == src[pos + length])
+            length++;
+
+         emit(out, src + anchor, pos - anchor, pos - candidate, length);
+         pos += length;
+         anchor = pos;
+      }
+      emit(out, src + anchor, size - anchor, 0, 0);
+   }
+
+   // Decompresses src into out (which must already be sized to the expected
+   // output). Returns false on malformed input.
+   inline bool decompress(const uint8_t* src, size_t size, uint8_t* out, size_t outSize)
+   {
+      size_t in = 0, pos = 0;
+      auto readLength = [&](size_t length) {
+         if (length != 15)
+            return length;
+         uint8_t byte;
+         do
+         {
+            byte = in < size ? src[in++] : 0;
+            length += byte;
+         } while (byte == 255);
+         return length;
+      };
+
+      while (in < size)
+      {
+         uint8_t token = src[in++];
+
+         size_t literals = readLength(token >> 4);
+         if (in + literals > size || pos + literals > outSize)
+            return false;
+         std::memcpy(out + pos, src + in, literals);
+         in += literals;
+         pos += literals;
+
+         if (in == size)
+            break; // Final sequence has no match
+
+         if (in + 2 > size)
+            return false;
+         size_t offset = src[in] | (src[in + 1] << 8);
+         in += 2;
+         size_t length = readLength(token & 0xf) + MIN_MATCH;
+         if (offset == 0 || offset > pos || pos + length > outSize)
+            return false;
+         for (size_t n = 0; n < length; n++, pos++) // Byte by byte, matches may overlap
+            out[pos] = out[pos - offset];
+      }
+      return pos == outSize;
+   }
+}
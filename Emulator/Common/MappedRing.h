@@ -0,0 +1,165 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// A file of fixed size records used as a ring and mapped into memory, so
+// appending a record is a couple of stores: no system call, no buffer to
+// flush, and what was written survives a crash. Once `capacity` records
+// are written the oldest are overwritten; the header counts every record
+// ever appended, so a reader knows which ones are still there.
+//
+//    Header: "8080RING", record size (u32), 0 (u32), capacity (u64), written (u64)
+//    Records: capacity * record size bytes, record n at n % capacity
+class MappedRing
+{
+public:
+   struct Header
+   {
+      char magic[8];
+      uint32_t recordSize;
+      uint32_t reserved;
+      uint64_t capacity;
+      uint64_t written;
+   };
+
+   // Creates (or truncates) `path` for writing
+   MappedRing(const std::string& path, uint32_t recordSize, uint64_t capacity)
+   {
+      if (recordSize == 0 || capacity == 0)
+         throw std::string("Empty ring ") + path;
+      map(path, sizeof(Header) + (uint64_t)recordSize * capacity, true);
+      std::memcpy(header->magic, magic(), 8);
+      header->recordSize = recordSize;
+      header->reserved = 0;
+      header->capacity = capacity;
+      header->written = 0;
+      next = records;
+      end = records + (size_t)recordSize * capacity;
+   }
+
+   // Opens an existing ring read only
+   explicit MappedRing(const std::string& path)
+   {
+      map(path, 0, false);
+      if (size < sizeof(Header) || std::memcmp(header->magic, magic(), 8) != 0 || header->recordSize == 0 || header->capacity == 0
+         || size < sizeof(Header) + (uint64_t)header->recordSize * header->capacity)
+      {
+         unmap();
+         throw std::string("Not a trace ring: ") + path;
+      }
+   }
+
+   ~MappedRing() { unmap(); }
+   MappedRing(const MappedRing&) = delete;
+   MappedRing& operator=(const MappedRing&) = delete;
+
+   // Space for the next record
+   void* append()
+   {
+      uint8_t* slot = next;
+      next += header->recordSize;
+      if (next == end)
+         next = records;
+      header->written++;
+      return slot;
+   }
+
+   uint32_t getRecordSize() const { return header->recordSize; }
+   uint64_t getWritten() const { return header->written; }
+   // Oldest record still in the ring
+   uint64_t getFirst() const { return header->written > header->capacity ? header->written - header->capacity : 0; }
+
+   // Record n, for getFirst() <= n < getWritten()
+   const void* record(uint64_t n) const { return records + (size_t)(n % header->capacity) * header->recordSize; }
+
+private:
+   static const char* magic() { return "8080RING"; }
+
+   void map(const std::string& path, uint64_t length, bool write)
+   {
+#ifdef _WIN32
+      file = CreateFileA(path.c_str(), write ? GENERIC_READ | GENERIC_WRITE : GENERIC_READ, FILE_SHARE_READ, nullptr,
+         write ? CREATE_ALWAYS : OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+      if (file == INVALID_HANDLE_VALUE)
+         throw std::string("Can't open ") + path;
+      if (!write)
+      {
+         LARGE_INTEGER fileSize;
+         GetFileSizeEx(file, &fileSize);
+         length = (uint64_t)fileSize.QuadPart;
+      }
+      mapping = length ? CreateFileMappingA(file, nullptr, write ? PAGE_READWRITE : PAGE_READONLY, (DWORD)(length >> 32), (DWORD)length, nullptr) : nullptr;
+      void* view = mapping ? MapViewOfFile(mapping, write ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, (SIZE_T)length) : nullptr;
+#else
+      fd = ::open(path.c_str(), write ? O_RDWR | O_CREAT | O_TRUNC : O_RDONLY, 0644);
+      if (fd < 0)
+         throw std::string("Can't open ") + path;
+      struct stat info;
+      if (!write && fstat(fd, &info) == 0)
+         length = (uint64_t)info.st_size;
+      void* view = nullptr;
+      if (length && (!write || ftruncate(fd, (off_t)length) == 0))
+      {
+         view = mmap(nullptr, (size_t)length, write ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+         if (view == MAP_FAILED)
+            view = nullptr;
+      }
+#endif
+      size = length;
+      base = (uint8_t*)view;
+      if (!base)
+      {
+         unmap();
+         throw std::string("Can't map ") + path;
+      }
+      header = (Header*)base;
+      records = base + sizeof(Header);
+   }
+
+   void unmap()
+   {
+#ifdef _WIN32
+      if (base)
+         UnmapViewOfFile(base);
+      if (mapping)
+         CloseHandle(mapping);
+      if (file != INVALID_HANDLE_VALUE)
+         CloseHandle(file);
+      mapping = nullptr;
+      file = INVALID_HANDLE_VALUE;
+#else
+      if (base)
+         munmap(base, (size_t)size);
+      if (fd >= 0)
+         ::close(fd);
+      fd = -1;
+#endif
+      base = nullptr;
+   }
+
+#ifdef _WIN32
+   HANDLE file = INVALID_HANDLE_VALUE;
+   HANDLE mapping = nullptr;
+#else
+   int fd = -1;
+#endif
+   uint64_t size = 0;
+   uint8_t* base = nullptr;
+   Header* header = nullptr;
+   uint8_t* records = nullptr;
+   uint8_t* next = nullptr;
+   uint8_t* end = nullptr;
+};
@@ -0,0 +1,381 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+// What the emulator, the disassembler and the profiler need to know about
+// each of the 256 opcodes, indexed by opcode.
+//
+// Mnemonics are the Z80 style ones the debug trace has always printed, with
+// '#' standing for the operand. Cycles are what Emulate8080Op charges:
+// `taken` for a conditional CALL or RET that is taken, `cycles` otherwise
+// (the two are equal for everything else). INR M, DCR M and MVI M are
+// charged like their register forms; the data sheet says 10.
+namespace Opcodes
+{
+   enum Flag : uint8_t { FLAG_CY = 0x01, FLAG_P = 0x04, FLAG_AC = 0x10, FLAG_Z = 0x40, FLAG_S = 0x80 }; // PSW bit positions
+   constexpr uint8_t FLAGS_ALL = FLAG_S | FLAG_Z | FLAG_AC | FLAG_P | FLAG_CY;
+
+   enum Operand : uint8_t
+   {
+      OPERAND_NONE,
+      OPERAND_BYTE,   // Immediate data
+      OPERAND_PORT,   // I/O port number
+      OPERAND_WORD,   // 16 bit data or data address
+      OPERAND_TARGET, // 16 bit code address
+   };
+
+   enum Flow : uint8_t
+   {
+      FLOW_NEXT,      // Falls through to the next instruction
+      FLOW_JUMP,      // To the operand
+      FLOW_JUMP_IF,   // To the operand or the next instruction
+      FLOW_CALL,
+      FLOW_CALL_IF,
+      FLOW_RETURN,
+      FLOW_RETURN_IF,
+      FLOW_RESTART,   // RST n: call to n * 8
+      FLOW_INDIRECT,  // PCHL: target only known at run time
+      FLOW_HALT,
+   };
+
+   struct Info
+   {
+      const char* mnemonic;
+      uint8_t length;       // Bytes, including the opcode
+      uint8_t cycles;
+      uint8_t taken;
+      uint8_t flagsRead;    // Flag bits
+      uint8_t flagsWritten;
+      Operand operand;
+      Flow flow;
+   };
+
+   constexpr Info TABLE[256] =
+   {
+      { "NOP",            1, 4,  4,  0,                 0,                                  OPERAND_NONE,   FLOW_NEXT }, // 00 NOP
+      { "LD     BC,#",    3, 10, 10, 0,                 0,                                  OPERAND_WORD,   FLOW_NEXT }, // 01 LXI B,d16
+      { "LD     (BC),A",  1, 7,  7,  0,                 0,                                  OPERAND_NONE,   FLOW_NEXT }, // 02 STAX B
+      { "INC    BC",      1, 5,  5,  0,                 0,                                  OPERAND_NONE,   FLOW_NEXT }, // 03 INX B
+      { "INC    B",       1, 5,  5,  0,                 FLAG_S | FLAG_Z | FLAG_AC | FLAG_P, OPERAND_NONE,   FLOW_NEXT }, // 04 INR B
+      { "DEC    B",       1, 5,  5,  0,                 FLAG_S | FLAG_Z | FLAG_AC | FLAG_P, OPERAND_NONE,   FLOW_NEXT }, // 05 DCR B
+      { "LD     B,#",     2, 7,  7,  0,                 0,                                  OPERAND_BYTE,   FLOW_NEXT }, // 06 MVI B,d8
+      { "RLCA",           1, 4,  4,  0,                 FLAG_CY,                            OPERAND_NONE,   FLOW_NEXT }, // 07 RLC
+      { "NOP",            1, 4,  4,  0,                 0,                                  OPERAND_NONE,   FLOW_NEXT }, // 08 unused
+      { "ADD    HL,BC",   1, 10, 10, 0,                 FLAG_CY,                            OPERAND_NONE,   FLOW_NEXT }, // 09 DAD B
+      { "LD     A,(BC)",  1, 7,  7,  0,                 0,                                  OPERAND_NONE,   FLOW_NEXT }, // 0a LDAX B
+      { "DEC    BC",      1, 5,  5,  0,                 0,                                  OPERAND_NONE,   FLOW_NEXT }, // 0b DCX B
+      { "INC    C",       1, 5,  5,  0,                 FLAG_S | FLAG_Z | FLAG_AC | FLAG_P, OPERAND_NONE,   FLOW_NEXT }, // 0c INR C
+      { "DEC    C",       1, 5,  5,  0,                 FLAG_S | FLAG_Z | FLAG_AC | FLAG_P, OPERAND_NONE,   FLOW_NEXT }, // 0d DCR C
+      { "LD     C,#",     2, 7,  7,  0,                 0,                                  OPERAND_BYTE,   FLOW_NEXT }, // 0e MVI C,d8
+      { "RRCA",           1, 4,  4,  0,                 FLAG_CY,                            OPERAND_NONE,   FLOW_NEXT }, // 0f RRC
+      { "NOP",            1, 4,  4,  0,                 0,                                  OPERAND_NONE,   FLOW_NEXT }, // 10 unused
+      { "LD     DE,#",    3, 10, 10, 0,                 0,                                  OPERAND_WORD,   FLOW_NEXT }, // 11 LXI D,d16
+      { "LD     (DE),A",  1, 7,  7,  0,                 0,                                  OPERAND_NONE,   FLOW_NEXT }, // 12 STAX D
+      { "INC    DE",      1, 5,  5,  0,                 0,                                  OPERAND_NONE,   FLOW_NEXT }, // 13 INX D
+      { "INC    D",       1, 5,  5,  0,                 FLAG_S | FLAG_Z | FLAG_AC | FLAG_P, OPERAND_NONE,   FLOW_NEXT }, // 14 INR D
+      { "DEC    D",       1, 5,  5,  0,                 FLAG_S | FLAG_Z | FLAG_AC | FLAG_P, OPERAND_NONE,   FLOW_NEXT }, // 15 DCR D
+      { "LD     D,#",     2, 7,  7,  0,                 0,                                  OPERAND_BYTE,   FLOW_NEXT }, // 16 MVI D,d8
+      { "RLA",            1, 4,  4,  FLAG_CY,           FLAG_CY,                            OPERAND_NONE,   FLOW_NEXT }, // 17 RAL
+      { "NOP",            1, 4,  4,  0,                 0,                                  OPERAND_NONE,   FLOW_NEXT }, // 18 unused
+      { "ADD    HL,DE",   1, 10, 10, 0,                 FLAG_CY,                            OPERAND_NONE,   FLOW_NEXT }, // 19 DAD D
+      { "LD     A,(DE)",  1, 7,  7,  0,                 0,                                  OPERAND_NONE,   FLOW_NEXT }, // 1a LDAX D
+      { "DEC    DE",      1, 5,  5,  0,                 0,                                  OPERAND_NONE,   FLOW_NEXT }, // 1b DCX D
+      { "INC    E",       1, 5,  5,  0,                 FLAG_S | FLAG_Z | FLAG_AC | FLAG_P, OPERAND_NONE,   FLOW_NEXT }, // 1c INR E
+      { "DEC    E",       1, 5,  5,  0,                 FLAG_S | FLAG_Z | FLAG_AC | FLAG_P, OPERAND_NONE,   FLOW_NEXT }, // 1d DCR E
+      { "LD     E,#",     2, 7,  7,  0,                 0,                                  OPERAND_BYTE,   FLOW_NEXT }, // 1e MVI E,d8
+      { "RRA",            1, 4,  4,  FLAG_CY,           FLAG_CY,                            OPERAND_NONE,   FLOW_NEXT }, // 1f RAR
+      { "NOP",            1, 4,  4,  0,                 0,                                  OPERAND_NONE,   FLOW_NEXT }, // 20 unused
+      { "LD     HL,#",    3, 10, 10, 0,                 0,                                  OPERAND_WORD,   FLOW_NEXT }, // 21 LXI H,d16
+      { "LD     (#),HL",  3, 16, 16, 0,                 0,                                  OPERAND_WORD,   FLOW_NEXT }, // 22 SHLD a16
+      { "INC    HL",      1, 5,  5,  0,                 0,                                  OPERAND_NONE,   FLOW_NEXT }, // 23 INX H
+      { "INC    H",       1, 5,  5,  0,                 FLAG_S | FLAG_Z | FLAG_AC | FLAG_P, OPERAND_NONE,   FLOW_NEXT }, // 24 INR H
+      { "DEC    H",       1, 5,  5,  0,                 FLAG_S | FLAG_Z | FLAG_AC | FLAG_P, OPERAND_NONE,   FLOW_NEXT }, // 25 DCR H
+      { "LD     H,#",     2, 7,  7,  0,                 0,                                  OPERAND_BYTE,   FLOW_NEXT }, // 26 MVI H,d8
+      { "DAA",            1, 4,  4,  FLAG_AC | FLAG_CY, FLAGS_ALL,                          OPERAND_NONE,   FLOW_NEXT }, // 27 DAA
+      { "NOP",            1, 4,  4,  0,                 0,                                  OPERAND_NONE,   FLOW_NEXT }, // 28 unused
+      { "ADD    HL,HL",   1, 10, 10, 0,                 FLAG_CY,                            OPERAND_NONE,   FLOW_NEXT }, // 29 DAD H
+      { "LD     HL,(#)",  3, 16, 16, 0,                 0,                                  OPERAND_WORD,   FLOW_NEXT }, // 2a LHLD a16
+      { "DEC    HL",      1, 5,  5,  0,                 0,                                  OPERAND_NONE,   FLOW_NEXT }, // 2b DCX H
+      { "INC    L",       1, 5,  5,  0,                 FLAG_S | FLAG_Z | FLAG_AC | FLAG_P, OPERAND_NONE,   FLOW_NEXT }, // 2c INR L
+      { "DEC    L",       1, 5,  5,  0,                 FLAG_S | FLAG_Z | FLAG_AC | FLAG_P, OPERAND_NONE,   FLOW_NEXT }, // 2d DCR L
+      { "LD     L,#",     2, 7,  7,  0,                 0,                                  OPERAND_BYTE,   FLOW_NEXT }, // 2e MVI L,d8
+      { "CMA",            1, 4,  4,  0,                 0,                                  OPERAND_NONE,   FLOW_NEXT }, // 2f CMA
+      { "NOP",            1, 4,  4,  0,                 0,                                  OPERAND_NONE,   FLOW_NEXT }, // 30 unused
+      { "LD     SP,#",    3, 10, 10, 0,                 0,                                  OPERAND_WORD,   FLOW_NEXT }, // 31 LXI SP,d16
+      { "LD     (#),A",   3, 13, 13, 0,                 0,                                  OPERAND_WORD,   FLOW_NEXT }, // 32 STA a16
+      { "INC    SP",      1, 5,  5,  0,                 0,                                  OPERAND_NONE,   FLOW_NEXT }, // 33 INX SP
+      { "INC    (HL)",    1, 5,  5,  0,                 FLAG_S | FLAG_Z | FLAG_AC | FLAG_P, OPERAND_NONE,   FLOW_NEXT }, // 34 INR M
+      { "DEC    (HL)",    1, 5,  5,  0,                 FLAG_S | FLAG_Z | FLAG_AC | FLAG_P, OPERAND_NONE,   FLOW_NEXT }, // 35 DCR M
+      { "LD     (HL),#",  2, 7,  7,  0,                 0,                                  OPERAND_BYTE,   FLOW_NEXT }, // 36 MVI M,d8
+      { "STC",            1, 4,  4,  0,                 FLAG_CY,                            OPERAND_NONE,   FLOW_NEXT }, // 37 STC
+      { "NOP",            1, 4,  4,  0,                 0,                                  OPERAND_NONE,   FLOW_NEXT }, // 38 unused
+      { "ADD    HL,SP",   1, 10, 10, 0,                 FLAG_CY,                            OPERAND_NONE,   FLOW_NEXT }, // 39 DAD SP
+      { "LD     A,(#)",   3, 13, 13, 0,                 0,                                  OPERAND_WORD,   FLOW_NEXT }, // 3a LDA a16
+      { "DEC    SP",      1, 5,  5,  0,                 0,                                  OPERAND_NONE,   FLOW_NEXT }, // 3b DCX SP
+      { "INC    A",       1, 5,  5,  0,                 FLAG_S | FLAG_Z | FLAG_AC | FLAG_P, OPERAND_NONE,   FLOW_NEXT }, // 3c INR A
+      { "DEC    A",       1, 5,  5,  0,                 FLAG_S | FLAG_Z | FLAG_AC | FLAG_P, OPERAND_NONE,   FLOW_NEXT }, // 3d DCR A
+      { "LD     A,#",     2, 7,  7,  0,                 0,                                  OPERAND_BYTE,   FLOW_NEXT }, // 3e MVI A,d8
+      { "CMC",            1, 4,  4,  FLAG_CY,           FLAG_CY,                            OPERAND_NONE,   FLOW_NEXT }, // 3f CMC
+      { "LD     B,B",     1, 5,  5,  0,                 0,                                  OPERAND_NONE,   FLOW_NEXT }, // 40 MOV B,B
+      { "LD     B,C",     1, 5,  5,  0,                 0,                                  OPERAND_NONE,   FLOW_NEXT }, // 41 MOV B,C
+      { "LD     B,D",     1, 5,  5,  0,                 0,                                  OPERAND_NONE,   FLOW_NEXT }, // 42 MOV B,D
+      { "LD     B,E",     1, 5,  5,  0,                 0,                                  OPERAND_NONE,   FLOW_NEXT }, // 43 MOV B,E
+      { "LD     B,H",     1, 5,  5,  0,                 0,                                  OPERAND_NONE,   FLOW_NEXT }, // 44 MOV B,H
+      { "LD     B,L",     1, 5,  5,  0,                 0,                                  OPERAND_NONE,   FLOW_NEXT }, // 45 MOV B,L
+      { "LD     B,(HL)",  1, 7,  7,  0,                 0,                                  OPERAND_NONE,   FLOW_NEXT }, // 46 MOV B,M
+      { "LD     B,A",     1, 5,  5,  0,                 0,                                  OPERAND_NONE,   FLOW_NEXT }, // 47 MOV B,A
+      { "LD     C,B",     1, 5,  5,  0,                 0,                                  OPERAND_NONE,   FLOW_NEXT }, // 48 MOV C,B
+      { "LD     C,C",     1, 5,  5,  0,                 0,                                  OPERAND_NONE,   FLOW_NEXT }, // 49 MOV C,C
+      { "LD     C,D",     1, 5,  5,  0,                 0,                                  OPERAND_NONE,   FLOW_NEXT }, // 4a MOV C,D
+      { "LD     C,E",     1, 5,  5,  0,                 0,                                  OPERAND_NONE,   FLOW_NEXT }, // 4b MOV C,E
+      { "LD     C,H",     1, 5,  5,  0,                 0,                                  OPERAND_NONE,   FLOW_NEXT }, // 4c MOV C,H
+      { "LD     C,L",     1, 5,  5,  0,                 0,                                  OPERAND_NONE,   FLOW_NEXT }, // 4d MOV C,L
+      { "LD     C,(HL)",  1, 7,  7,  0,                 0,                                  OPERAND_NONE,   FLOW_NEXT }, // 4e MOV C,M
+      { "LD     C,A",     1, 5,  5,  0,                 0,                                  OPERAND_NONE,   FLOW_NEXT }, // 4f MOV C,A
+      { "LD     D,B",     1, 5,  5,  0,                 0,                                  OPERAND_NONE,   FLOW_NEXT }, // 50 MOV D,B
+      { "LD     D,C",     1, 5,  5,  0,                 0,                                  OPERAND_NONE,   FLOW_NEXT }, // 51 MOV D,C
+      { "LD     D,D",     1, 5,  5,  0,                 0,                                  OPERAND_NONE,   FLOW_NEXT }, // 52 MOV D,D
+      { "LD     D,E",     1, 5,  5,  0,                 0,                                  OPERAND_NONE,   FLOW_NEXT }, // 53 MOV D,E
+      { "LD     D,H",     1, 5,  5,  0,                 0,                                  OPERAND_NONE,   FLOW_NEXT }, // 54 MOV D,H
+      { "LD     D,L",     1, 5,  5,  0,                 0,                                  OPERAND_NONE,   FLOW_NEXT }, // 55 MOV D,L
+      { "LD     D,(HL)",  1, 7,  7,  0,                 0,                                  OPERAND_NONE,   FLOW_NEXT }, // 56 MOV D,M
+      { "LD     D,A",     1, 5,  5,  0,                 0,                                  OPERAND_NONE,   FLOW_NEXT }, // 57 MOV D,A
+      { "LD     E,B",     1, 5,  5,  0,                 0,                                  OPERAND_NONE,   FLOW_NEXT }, // 58 MOV E,B
+      { "LD     E,C",     1, 5,  5,  0,                 0,                                  OPERAND_NONE,   FLOW_NEXT }, // 59 MOV E,C
+      { "LD     E,D",     1, 5,  5,  0,                 0,                                  OPERAND_NONE,   FLOW_NEXT }, // 5a MOV E,D
+      { "LD     E,E",     1, 5,  5,  0,                 0,                                  OPERAND_NONE,   FLOW_NEXT }, // 5b MOV E,E
+      { "LD     E,H",     1, 5,  5,  0,                 0,                                  OPERAND_NONE,   FLOW_NEXT }, // 5c MOV E,H
+      { "LD     E,L",     1, 5,  5,  0,                 0,                                  OPERAND_NONE,   FLOW_NEXT }, // 5d MOV E,L
+      { "LD     E,(HL)",  1, 7,  7,  0,                 0,                                  OPERAND_NONE,   FLOW_NEXT }, // 5e MOV E,M
+      { "LD     E,A",     1, 5,  5,  0,                 0,                                  OPERAND_NONE,   FLOW_NEXT }, // 5f MOV E,A
+      { "LD     H,B",     1, 5,  5,  0,                 0,                                  OPERAND_NONE,   FLOW_NEXT }, // 60 MOV H,B
+      { "LD     H,C",     1, 5,  5,  0,                 0,                                  OPERAND_NONE,   FLOW_NEXT }, // 61 MOV H,C
+      { "LD     H,D",     1, 5,  5,  0,                 0,                                  OPERAND_NONE,   FLOW_NEXT }, // 62 MOV H,D
+      { "LD     H,E",     1, 5,  5,  0,                 0,                                  OPERAND_NONE,   FLOW_NEXT }, // 63 MOV H,E
+      { "LD     H,H",     1, 5,  5,  0,                 0,                                  OPERAND_NONE,   FLOW_NEXT }, // 64 MOV H,H
+      { "LD     H,L",     1, 5,  5,  0,                 0,                                  OPERAND_NONE,   FLOW_NEXT }, // 65 MOV H,L
+      { "LD     H,(HL)",  1, 7,  7,  0,                 0,                                  OPERAND_NONE,   FLOW_NEXT }, // 66 MOV H,M
+      { "LD     H,A",     1, 5,  5,  0,                 0,                                  OPERAND_NONE,   FLOW_NEXT }, // 67 MOV H,A
+      { "LD     L,B",     1, 5,  5,  0,                 0,                                  OPERAND_NONE,   FLOW_NEXT }, // 68 MOV L,B
+      { "LD     L,C",     1, 5,  5,  0,                 0,                                  OPERAND_NONE,   FLOW_NEXT }, // 69 MOV L,C
+      { "LD     L,D",     1, 5,  5,  0,                 0,                                  OPERAND_NONE,   FLOW_NEXT }, // 6a MOV L,D
+      { "LD     L,E",     1, 5,  5,  0,                 0,                                  OPERAND_NONE,   FLOW_NEXT }, // 6b MOV L,E
+      { "LD     L,H",     1, 5,  5,  0,                 0,                                  OPERAND_NONE,   FLOW_NEXT }, // 6c MOV L,H
+      { "LD     L,L",     1, 5,  5,  0,                 0,                                  OPERAND_NONE,   FLOW_NEXT }, // 6d MOV L,L
+      { "LD     L,(HL)",  1, 7,  7,  0,                 0,                                  OPERAND_NONE,   FLOW_NEXT }, // 6e MOV L,M
+      { "LD     L,A",     1, 5,  5,  0,                 0,                                  OPERAND_NONE,   FLOW_NEXT }, // 6f MOV L,A
+      { "LD     (HL),B",  1, 7,  7,  0,                 0,                                  OPERAND_NONE,   FLOW_NEXT }, // 70 MOV M,B
+      { "LD     (HL),C",  1, 7,  7,  0,                 0,                                  OPERAND_NONE,   FLOW_NEXT }, // 71 MOV M,C
+      { "LD     (HL),D",  1, 7,  7,  0,                 0,                                  OPERAND_NONE,   FLOW_NEXT }, // 72 MOV M,D
+      { "LD     (HL),E",  1, 7,  7,  0,                 0,                                  OPERAND_NONE,   FLOW_NEXT }, // 73 MOV M,E
+      { "LD     (HL),H",  1, 7,  7,  0,                 0,                                  OPERAND_NONE,   FLOW_NEXT }, // 74 MOV M,H
+      { "LD     (HL),L",  1, 7,  7,  0,                 0,                                  OPERAND_NONE,   FLOW_NEXT }, // 75 MOV M,L
+      { "HLT",            1, 7,  7,  0,                 0,                                  OPERAND_NONE,   FLOW_HALT }, // 76 HLT
+      { "LD     (HL),A",  1, 7,  7,  0,                 0,                                  OPERAND_NONE,   FLOW_NEXT }, // 77 MOV M,A
+      { "LD     A,B",     1, 5,  5,  0,                 0,                                  OPERAND_NONE,   FLOW_NEXT }, // 78 MOV A,B
+      { "LD     A,C",     1, 5,  5,  0,                 0,                                  OPERAND_NONE,   FLOW_NEXT }, // 79 MOV A,C
+      { "LD     A,D",     1, 5,  5,  0,                 0,                                  OPERAND_NONE,   FLOW_NEXT }, // 7a MOV A,D
+      { "LD     A,E",     1, 5,  5,  0,                 0,                                  OPERAND_NONE,   FLOW_NEXT }, // 7b MOV A,E
+      { "LD     A,H",     1, 5,  5,  0,                 0,                                  OPERAND_NONE,   FLOW_NEXT }, // 7c MOV A,H
+      { "LD     A,L",     1, 5,  5,  0,                 0,                                  OPERAND_NONE,   FLOW_NEXT }, // 7d MOV A,L
+      { "LD     A,(HL)",  1, 7,  7,  0,                 0,                                  OPERAND_NONE,   FLOW_NEXT }, // 7e MOV A,M
+      { "LD     A,A",     1, 5,  5,  0,                 0,                                  OPERAND_NONE,   FLOW_NEXT }, // 7f MOV A,A
+      { "ADD    A,B",     1, 4,  4,  0,                 FLAGS_ALL,                          OPERAND_NONE,   FLOW_NEXT }, // 80 ADD B
+      { "ADD    A,C",     1, 4,  4,  0,                 FLAGS_ALL,                          OPERAND_NONE,   FLOW_NEXT }, // 81 ADD C
+      { "ADD    A,D",     1, 4,  4,  0,                 FLAGS_ALL,                          OPERAND_NONE,   FLOW_NEXT }, // 82 ADD D
+      { "ADD    A,E",     1, 4,  4,  0,                 FLAGS_ALL,                          OPERAND_NONE,   FLOW_NEXT }, // 83 ADD E
+      { "ADD    A,H",     1, 4,  4,  0,                 FLAGS_ALL,                          OPERAND_NONE,   FLOW_NEXT }, // 84 ADD H
+      { "ADD    A,L",     1, 4,  4,  0,                 FLAGS_ALL,                          OPERAND_NONE,   FLOW_NEXT }, // 85 ADD L
+      { "ADD    A,(HL)",  1, 7,  7,  0,                 FLAGS_ALL,                          OPERAND_NONE,   FLOW_NEXT }, // 86 ADD M
+      { "ADD    A,A",     1, 4,  4,  0,                 FLAGS_ALL,                          OPERAND_NONE,   FLOW_NEXT }, // 87 ADD A
+      { "ADC    A,B",     1, 4,  4,  FLAG_CY,           FLAGS_ALL,                          OPERAND_NONE,   FLOW_NEXT }, // 88 ADC B
+      { "ADC    A,C",     1, 4,  4,  FLAG_CY,           FLAGS_ALL,                          OPERAND_NONE,   FLOW_NEXT }, // 89 ADC C
+      { "ADC    A,D",     1, 4,  4,  FLAG_CY,           FLAGS_ALL,                          OPERAND_NONE,   FLOW_NEXT }, // 8a ADC D
+      { "ADC    A,E",     1, 4,  4,  FLAG_CY,           FLAGS_ALL,                          OPERAND_NONE,   FLOW_NEXT }, // 8b ADC E
+      { "ADC    A,H",     1, 4,  4,  FLAG_CY,           FLAGS_ALL,                          OPERAND_NONE,   FLOW_NEXT }, // 8c ADC H
+      { "ADC    A,L",     1, 4,  4,  FLAG_CY,           FLAGS_ALL,                          OPERAND_NONE,   FLOW_NEXT }, // 8d ADC L
+      { "ADC    A,(HL)",  1, 7,  7,  FLAG_CY,           FLAGS_ALL,                          OPERAND_NONE,   FLOW_NEXT }, // 8e ADC M
+      { "ADC    A,A",     1, 4,  4,  FLAG_CY,           FLAGS_ALL,                          OPERAND_NONE,   FLOW_NEXT }, // 8f ADC A
+      { "SUB    A,B",     1, 4,  4,  0,                 FLAGS_ALL,                          OPERAND_NONE,   FLOW_NEXT }, // 90 SUB B
+      { "SUB    A,C",     1, 4,  4,  0,                 FLAGS_ALL,                          OPERAND_NONE,   FLOW_NEXT }, // 91 SUB C
+      { "SUB    A,D",     1, 4,  4,  0,                 FLAGS_ALL,                          OPERAND_NONE,   FLOW_NEXT }, // 92 SUB D
+      { "SUB    A,E",     1, 4,  4,  0,                 FLAGS_ALL,                          OPERAND_NONE,   FLOW_NEXT }, // 93 SUB E
+      { "SUB    A,H",     1, 4,  4,  0,                 FLAGS_ALL,                          OPERAND_NONE,   FLOW_NEXT }, // 94 SUB H
+      { "SUB    A,L",     1, 4,  4,  0,                 FLAGS_ALL,                          OPERAND_NONE,   FLOW_NEXT }, // 95 SUB L
+      { "SUB    A,(HL)",  1, 7,  7,  0,                 FLAGS_ALL,                          OPERAND_NONE,   FLOW_NEXT }, // 96 SUB M
+      { "SUB    A,A",     1, 4,  4,  0,                 FLAGS_ALL,                          OPERAND_NONE,   FLOW_NEXT }, // 97 SUB A
+      { "SBB    A,B",     1, 4,  4,  FLAG_CY,           FLAGS_ALL,                          OPERAND_NONE,   FLOW_NEXT }, // 98 SBB B
+      { "SBB    A,C",     1, 4,  4,  FLAG_CY,           FLAGS_ALL,                          OPERAND_NONE,   FLOW_NEXT }, // 99 SBB C
+      { "SBB    A,D",     1, 4,  4,  FLAG_CY,           FLAGS_ALL,                          OPERAND_NONE,   FLOW_NEXT }, // 9a SBB D
+      { "SBB    A,E",     1, 4,  4,  FLAG_CY,           FLAGS_ALL,                          OPERAND_NONE,   FLOW_NEXT }, // 9b SBB E
+      { "SBB    A,H",     1, 4,  4,  FLAG_CY,           FLAGS_ALL,                          OPERAND_NONE,   FLOW_NEXT }, // 9c SBB H
+      { "SBB    A,L",     1, 4,  4,  FLAG_CY,           FLAGS_ALL,                          OPERAND_NONE,   FLOW_NEXT }, // 9d SBB L
+      { "SBB    A,(HL)",  1, 7,  7,  FLAG_CY,           FLAGS_ALL,                          OPERAND_NONE,   FLOW_NEXT }, // 9e SBB M
+      { "SBB    A,A",     1, 4,  4,  FLAG_CY,           FLAGS_ALL,                          OPERAND_NONE,   FLOW_NEXT }, // 9f SBB A
+      { "AND    A,B",     1, 4,  4,  0,                 FLAGS_ALL,                          OPERAND_NONE,   FLOW_NEXT }, // a0 ANA B
+      { "AND    A,C",     1, 4,  4,  0,                 FLAGS_ALL,                          OPERAND_NONE,   FLOW_NEXT }, // a1 ANA C
+      { "AND    A,D",     1, 4,  4,  0,                 FLAGS_ALL,                          OPERAND_NONE,   FLOW_NEXT }, // a2 ANA D
+      { "AND    A,E",     1, 4,  4,  0,                 FLAGS_ALL,                          OPERAND_NONE,   FLOW_NEXT }, // a3 ANA E
+      { "AND    A,H",     1, 4,  4,  0,                 FLAGS_ALL,                          OPERAND_NONE,   FLOW_NEXT }, // a4 ANA H
+      { "AND    A,L",     1, 4,  4,  0,                 FLAGS_ALL,                          OPERAND_NONE,   FLOW_NEXT }, // a5 ANA L
+      { "AND    A,(HL)",  1, 7,  7,  0,                 FLAGS_ALL,                          OPERAND_NONE,   FLOW_NEXT }, // a6 ANA M
+      { "AND    A,A",     1, 4,  4,  0,                 FLAGS_ALL,                          OPERAND_NONE,   FLOW_NEXT }, // a7 ANA A
+      { "XOR    A,B",     1, 4,  4,  0,                 FLAGS_ALL,                          OPERAND_NONE,   FLOW_NEXT }, // a8 XRA B
+      { "XOR    A,C",     1, 4,  4,  0,                 FLAGS_ALL,                          OPERAND_NONE,   FLOW_NEXT }, // a9 XRA C
+      { "XOR    A,D",     1, 4,  4,  0,                 FLAGS_ALL,                          OPERAND_NONE,   FLOW_NEXT }, // aa XRA D
+      { "XOR    A,E",     1, 4,  4,  0,                 FLAGS_ALL,                          OPERAND_NONE,   FLOW_NEXT }, // ab XRA E
+      { "XOR    A,H",     1, 4,  4,  0,                 FLAGS_ALL,                          OPERAND_NONE,   FLOW_NEXT }, // ac XRA H
+      { "XOR    A,L",     1, 4,  4,  0,                 FLAGS_ALL,                          OPERAND_NONE,   FLOW_NEXT }, // ad XRA L
+      { "XOR    A,(HL)",  1, 7,  7,  0,                 FLAGS_ALL,                          OPERAND_NONE,   FLOW_NEXT }, // ae XRA M
+      { "XOR    A,A",     1, 4,  4,  0,                 FLAGS_ALL,                          OPERAND_NONE,   FLOW_NEXT }, // af XRA A
+      { "OR     A,B",     1, 4,  4,  0,                 FLAGS_ALL,                          OPERAND_NONE,   FLOW_NEXT }, // b0 ORA B
+      { "OR     A,C",     1, 4,  4,  0,                 FLAGS_ALL,                          OPERAND_NONE,   FLOW_NEXT }, // b1 ORA C
+      { "OR     A,D",     1, 4,  4,  0,                 FLAGS_ALL,                          OPERAND_NONE,   FLOW_NEXT }, // b2 ORA D
+      { "OR     A,E",     1, 4,  4,  0,                 FLAGS_ALL,                          OPERAND_NONE,   FLOW_NEXT }, // b3 ORA E
+      { "OR     A,H",     1, 4,  4,  0,                 FLAGS_ALL,                          OPERAND_NONE,   FLOW_NEXT }, // b4 ORA H
+      { "OR     A,L",     1, 4,  4,  0,                 FLAGS_ALL,                          OPERAND_NONE,   FLOW_NEXT }, // b5 ORA L
+      { "OR     A,(HL)",  1, 7,  7,  0,                 FLAGS_ALL,                          OPERAND_NONE,   FLOW_NEXT }, // b6 ORA M
+      { "OR     A,A",     1, 4,  4,  0,                 FLAGS_ALL,                          OPERAND_NONE,   FLOW_NEXT }, // b7 ORA A
+      { "CP     A,B",     1, 4,  4,  0,                 FLAGS_ALL,                          OPERAND_NONE,   FLOW_NEXT }, // b8 CMP B
+      { "CP     A,C",     1, 4,  4,  0,                 FLAGS_ALL,                          OPERAND_NONE,   FLOW_NEXT }, // b9 CMP C
+      { "CP     A,D",     1, 4,  4,  0,                 FLAGS_ALL,                          OPERAND_NONE,   FLOW_NEXT }, // ba CMP D
+      { "CP     A,E",     1, 4,  4,  0,                 FLAGS_ALL,                          OPERAND_NONE,   FLOW_NEXT }, // bb CMP E
+      { "CP     A,H",     1, 4,  4,  0,                 FLAGS_ALL,                          OPERAND_NONE,   FLOW_NEXT }, // bc CMP H
+      { "CP     A,L",     1, 4,  4,  0,                 FLAGS_ALL,                          OPERAND_NONE,   FLOW_NEXT }, // bd CMP L
+      { "CP     A,(HL)",  1, 7,  7,  0,                 FLAGS_ALL,                          OPERAND_NONE,   FLOW_NEXT }, // be CMP M
+      { "CP     A,A",     1, 4,  4,  0,                 FLAGS_ALL,                          OPERAND_NONE,   FLOW_NEXT }, // bf CMP A
+      { "RET    NZ",      1, 5,  11, FLAG_Z,            0,                                  OPERAND_NONE,   FLOW_RETURN_IF }, // c0 RNZ
+      { "POP    BC",      1, 10, 10, 0,                 0,                                  OPERAND_NONE,   FLOW_NEXT }, // c1 POP B
+      { "JP     NZ,#",    3, 10, 10, FLAG_Z,            0,                                  OPERAND_TARGET, FLOW_JUMP_IF }, // c2 JNZ a16
+      { "JP     #",       3, 10, 10, 0,                 0,                                  OPERAND_TARGET, FLOW_JUMP }, // c3 JMP a16
+      { "CALL   NZ,#",    3, 11, 17, FLAG_Z,            0,                                  OPERAND_TARGET, FLOW_CALL_IF }, // c4 CNZ a16
+      { "PUSH   BC",      1, 11, 11, 0,                 0,                                  OPERAND_NONE,   FLOW_NEXT }, // c5 PUSH B
+      { "ADD    A,#",     2, 7,  7,  0,                 FLAGS_ALL,                          OPERAND_BYTE,   FLOW_NEXT }, // c6 ADI d8
+      { "RST    0",       1, 11, 11, 0,                 0,                                  OPERAND_NONE,   FLOW_RESTART }, // c7 RST 0
+      { "RET    Z",       1, 5,  11, FLAG_Z,            0,                                  OPERAND_NONE,   FLOW_RETURN_IF }, // c8 RZ
+      { "RET",            1, 10, 10, 0,                 0,                                  OPERAND_NONE,   FLOW_RETURN }, // c9 RET
+      { "JP     Z,#",     3, 10, 10, FLAG_Z,            0,                                  OPERAND_TARGET, FLOW_JUMP_IF }, // ca JZ a16
+      { "NOP",            1, 4,  4,  0,                 0,                                  OPERAND_NONE,   FLOW_NEXT }, // cb unused
+      { "CALL   Z,#",     3, 11, 17, FLAG_Z,            0,                                  OPERAND_TARGET, FLOW_CALL_IF }, // cc CZ a16
+      { "CALL   #",       3, 17, 17, 0,                 0,                                  OPERAND_TARGET, FLOW_CALL }, // cd CALL a16
+      { "ADC    A,#",     2, 7,  7,  FLAG_CY,           FLAGS_ALL,                          OPERAND_BYTE,   FLOW_NEXT }, // ce ACI d8
+      { "RST    1",       1, 11, 11, 0,                 0,                                  OPERAND_NONE,   FLOW_RESTART }, // cf RST 1
+      { "RET    NC",      1, 5,  11, FLAG_CY,           0,                                  OPERAND_NONE,   FLOW_RETURN_IF }, // d0 RNC
+      { "POP    DE",      1, 10, 10, 0,                 0,                                  OPERAND_NONE,   FLOW_NEXT }, // d1 POP D
+      { "JP     NC,#",    3, 10, 10, FLAG_CY,           0,                                  OPERAND_TARGET, FLOW_JUMP_IF }, // d2 JNC a16
+      { "OUT    (#),A",   2, 10, 10, 0,                 0,                                  OPERAND_PORT,   FLOW_NEXT }, // d3 OUT d8
+      { "CALL   NC,#",    3, 11, 17, FLAG_CY,           0,                                  OPERAND_TARGET, FLOW_CALL_IF }, // d4 CNC a16
+      { "PUSH   DE",      1, 11, 11, 0,                 0,                                  OPERAND_NONE,   FLOW_NEXT }, // d5 PUSH D
+      { "SUB    A,#",     2, 7,  7,  0,                 FLAGS_ALL,                          OPERAND_BYTE,   FLOW_NEXT }, // d6 SUI d8
+      { "RST    2",       1, 11, 11, 0,                 0,                                  OPERAND_NONE,   FLOW_RESTART }, // d7 RST 2
+      { "RET    C",       1, 5,  11, FLAG_CY,           0,                                  OPERAND_NONE,   FLOW_RETURN_IF }, // d8 RC
+      { "NOP",            1, 4,  4,  0,                 0,                                  OPERAND_NONE,   FLOW_NEXT }, // d9 unused
+      { "JP     C,#",     3, 10, 10, FLAG_CY,           0,                                  OPERAND_TARGET, FLOW_JUMP_IF }, // da JC a16
+      { "IN     A,(#)",   2, 10, 10, 0,                 0,                                  OPERAND_PORT,   FLOW_NEXT }, // db IN d8
+      { "CALL   C,#",     3, 11, 17, FLAG_CY,           0,                                  OPERAND_TARGET, FLOW_CALL_IF }, // dc CC a16
+      { "NOP",            1, 4,  4,  0,                 0,                                  OPERAND_NONE,   FLOW_NEXT }, // dd unused
+      { "SUB    A,#",     2, 7,  7,  FLAG_CY,           FLAGS_ALL,                          OPERAND_BYTE,   FLOW_NEXT }, // de SBI d8
+      { "RST    3",       1, 11, 11, 0,                 0,                                  OPERAND_NONE,   FLOW_RESTART }, // df RST 3
+      { "RET    PO",      1, 5,  11, FLAG_P,            0,                                  OPERAND_NONE,   FLOW_RETURN_IF }, // e0 RPO
+      { "POP    HL",      1, 10, 10, 0,                 0,                                  OPERAND_NONE,   FLOW_NEXT }, // e1 POP H
+      { "JP     PO,#",    3, 10, 10, FLAG_P,            0,                                  OPERAND_TARGET, FLOW_JUMP_IF }, // e2 JPO a16
+      { "EX     (SP),HL", 1, 18, 18, 0,                 0,                                  OPERAND_NONE,   FLOW_NEXT }, // e3 XTHL
+      { "CALL   PO,#",    3, 11, 17, FLAG_P,            0,                                  OPERAND_TARGET, FLOW_CALL_IF }, // e4 CPO a16
+      { "PUSH   HL",      1, 11, 11, 0,                 0,                                  OPERAND_NONE,   FLOW_NEXT }, // e5 PUSH H
+      { "AND    A,#",     2, 7,  7,  0,                 FLAGS_ALL,                          OPERAND_BYTE,   FLOW_NEXT }, // e6 ANI d8
+      { "RST    4",       1, 11, 11, 0,                 0,                                  OPERAND_NONE,   FLOW_RESTART }, // e7 RST 4
+      { "RET    PE",      1, 5,  11, FLAG_P,            0,                                  OPERAND_NONE,   FLOW_RETURN_IF }, // e8 RPE
+      { "JP     (HL)",    1, 5,  5,  0,                 0,                                  OPERAND_NONE,   FLOW_INDIRECT }, // e9 PCHL
+      { "JP     PE,#",    3, 10, 10, FLAG_P,            0,                                  OPERAND_TARGET, FLOW_JUMP_IF }, // ea JPE a16
+      { "EX     DE,HL",   1, 5,  5,  0,                 0,                                  OPERAND_NONE,   FLOW_NEXT }, // eb XCHG
+      { "CALL   PE,#",    3, 11, 17, FLAG_P,            0,                                  OPERAND_TARGET, FLOW_CALL_IF }, // ec CPE a16
+      { "NOP",            1, 4,  4,  0,                 0,                                  OPERAND_NONE,   FLOW_NEXT }, // ed unused
+      { "XOR    A,#",     2, 7,  7,  0,                 FLAGS_ALL,                          OPERAND_BYTE,   FLOW_NEXT }, // ee XRI d8
+      { "RST    5",       1, 11, 11, 0,                 0,                                  OPERAND_NONE,   FLOW_RESTART }, // ef RST 5
+      { "RET    P",       1, 5,  11, FLAG_S,            0,                                  OPERAND_NONE,   FLOW_RETURN_IF }, // f0 RP
+      { "POP    PSW",     1, 10, 10, 0,                 FLAGS_ALL,                          OPERAND_NONE,   FLOW_NEXT }, // f1 POP PSW
+      { "JP     P,#",     3, 10, 10, FLAG_S,            0,                                  OPERAND_TARGET, FLOW_JUMP_IF }, // f2 JP a16
+      { "DI",             1, 4,  4,  0,                 0,                                  OPERAND_NONE,   FLOW_NEXT }, // f3 DI
+      { "CALL   P,#",     3, 11, 17, FLAG_S,            0,                                  OPERAND_TARGET, FLOW_CALL_IF }, // f4 CP a16
+      { "PUSH   PSW",     1, 11, 11, FLAGS_ALL,         0,                                  OPERAND_NONE,   FLOW_NEXT }, // f5 PUSH PSW
+      { "OR     A,#",     2, 7,  7,  0,                 FLAGS_ALL,                          OPERAND_BYTE,   FLOW_NEXT }, // f6 ORI d8
+      { "RST    6",       1, 11, 11, 0,                 0,                                  OPERAND_NONE,   FLOW_RESTART }, // f7 RST 6
+      { "RET    M",       1, 5,  11, FLAG_S,            0,                                  OPERAND_NONE,   FLOW_RETURN_IF }, // f8 RM
+      { "LD     SP,HL",   1, 5,  5,  0,                 0,                                  OPERAND_NONE,   FLOW_NEXT }, // f9 SPHL
+      { "JP     M,#",     3, 10, 10, FLAG_S,            0,                                  OPERAND_TARGET, FLOW_JUMP_IF }, // fa JM a16
+      { "EI",             1, 4,  4,  0,                 0,                                  OPERAND_NONE,   FLOW_NEXT }, // fb EI
+      { "CALL   M,#",     3, 11, 17, FLAG_S,            0,                                  OPERAND_TARGET, FLOW_CALL_IF }, // fc CM a16
+      { "NOP",            1, 4,  4,  0,                 0,                                  OPERAND_NONE,   FLOW_NEXT }, // fd unused
+      { "CP     #",       2, 7,  7,  0,                 FLAGS_ALL,                          OPERAND_BYTE,   FLOW_NEXT }, // fe CPI d8
+      { "RST    7",       1, 11, 11, 0,                 0,                                  OPERAND_NONE,   FLOW_RESTART }, // ff RST 7
+   };
+
+   constexpr bool complete(int opcode = 0)
+   {
+      return opcode == 256 || (TABLE[opcode].mnemonic && TABLE[opcode].length && TABLE[opcode].cycles && complete(opcode + 1));
+   }
+   static_assert(complete(), "Every opcode needs a table entry");
+
+   // RST n and interrupt opcodes: where they call
+   constexpr uint16_t restartAddress(uint8_t opcode) { return opcode & 0x38; }
+
+   inline void appendHex(std::string& out, unsigned value, int digits)
+   {
+      static const char DIGITS[] = "0123456789abcdef";
+      for (int shift = 4 * (digits - 1); shift >= 0; shift -= 4)
+         out += DIGITS[(value >> shift) & 0xf];
+   }
+
+   // Returns a name for a 16 bit operand, or nullptr to print it as $xxxx
+   typedef const char* (*NameLookup)(uint16_t address, Operand kind, void* context);
+
+   // Appends the mnemonic of the instruction at `code` and returns its length
+   inline int disassemble(const uint8_t* code, std::string& out, NameLookup names = nullptr, void* context = nullptr)
+   {
+      const Info& op = TABLE[code[0]];
+      for (const char* c = op.mnemonic; *c; c++)
+      {
+         if (*c != '#')
+            out += *c;
+         else if (op.operand == OPERAND_BYTE || op.operand == OPERAND_PORT)
+         {
+            out += '$';
+            appendHex(out, code[1], 2);
+         }
+         else
+         {
+            uint16_t address = code[2] << 8 | code[1];
+            const char* name = names ? names(address, op.operand, context) : nullptr;
+            if (name)
+               out += name;
+            else
+            {
+               out += '$';
+               appendHex(out, address, 4);
+            }
+         }
+      }
+      return op.length;
+   }
+
+   // The debug trace layout: address, up to 3 bytes, mnemonic padded to 26
+   inline int listing(uint16_t pc, const uint8_t* code, std::string& out, NameLookup names = nullptr, void* context = nullptr)
+   {
+      int length = TABLE[code[0]].length;
+      appendHex(out, pc, 4);
+      out += ' ';
+      for (int n = 0; n < 3; n++)
+      {
+         if (n < length)
+            appendHex(out, code[n], 2);
+         else
+            out += "  ";
+         out += ' ';
+      }
+      size_t start = out.size();
+      disassemble(code, out, names, context);
+      if (out.size() - start < 26)
+         out.append(26 - (out.size() - start), ' ');
+      return length;
+   }
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+// Lock-free single producer, single consumer ring buffer.
+//
+// Exactly one thread may call push() and exactly one (other) thread may call
+// pop(). Capacity must be a power of two so indices can be masked instead of
+// wrapped, and head/tail are free running counters so full and empty never
+// look the same.
+template<typename T, std::size_t Capacity>
+class SPSCRing
+{
+   static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+public:
+   SPSCRing() : buffer(Capacity) {}
+
+   bool push(const T& item) // Producer only
+   {
+      std::size_t head = this->head.load(std::memory_order_relaxed);
+      if (head - tail.load(std::memory_order_acquire) == Capacity)
+         return false; // Full
+      buffer[head & (Capacity - 1)] = item;
+      this->head.store(head + 1, std::memory_order_release);
+      return true;
+   }
+
+   bool pop(T& item) // Consumer only
+   {
+      std::size_t tail = this->tail.load(std::memory_order_relaxed);
+      if (head.load(std::memory_order_acquire) == tail)
+         return false; // Empty
+      item = buffer[tail & (Capacity - 1)];
+      this->tail.store(tail + 1, std::memory_order_release);
+      return true;
+   }
+
+   std::size_t pop(T* items, std::size_t max) // Consumer only, drains up to max items at once
+   {
+      std::size_t tail = this->tail.load(std::memory_order_relaxed);
+      std::size_t count = head.load(std::memory_order_acquire) - tail;
+      if (count > max)
+         count = max;
+      for (std::size_t n = 0; n < count; n++)
+         items[n] = buffer[(tail + n) & (Capacity - 1)];
+      this->tail.store(tail + count, std::memory_order_release);
+      return count;
+   }
+
+   bool empty() const { return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire); }
+
+private:
+   std::vector<T> buffer;
+
+   // Kept on separate cache lines so producer and consumer don't false share
+   alignas(64) std::atomic<std::size_t> head{ 0 }; // Next slot to write
+   alignas(64) std::atomic<std::size_t> tail{ 0 }; // Next slot to read
+};
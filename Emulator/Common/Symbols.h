@@ -0,0 +1,180 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "Opcodes.h"
+
+// Names for ROM routines and RAM variables, read from a symbol file so
+// another ROM, or better names for this one, only need a new file. One
+// symbol per line, # starts a comment:
+//
+//    <hex address> <size in bytes, 0 if not known> <name> code|data
+//
+// Common/invaders.sym is the map for Space Invaders. Symbols are kept
+// sorted by address, with an index sorted by name, so lookups either way
+// are a binary search.
+class Symbols
+{
+public:
+   enum Type : uint8_t { CODE, DATA };
+
+   struct Symbol
+   {
+      uint16_t address;
+      uint16_t size; // 0: not known, runs up to the next symbol
+      std::string name;
+      Type type;
+   };
+
+   // The shipped map, seen from the directory of `program` (argv[0]): the
+   // Intel8080, Intel8080GUI or Tools build directory
+   static std::string defaultPath(const std::string& program)
+   {
+      size_t slash = program.find_last_of("/\\");
+      return (slash == std::string::npos ? "" : program.substr(0, slash + 1)) + "../Common/invaders.sym";
+   }
+
+   // Adds the file's symbols. Throws a std::string naming the file and line.
+   void load(const std::string& path)
+   {
+      std::ifstream stream(path);
+      if (!stream)
+         throw std::string("Can't read symbols from ") + path;
+      std::string line;
+      for (int number = 1; std::getline(stream, line); number++)
+      {
+         line = line.substr(0, line.find('#'));
+         std::istringstream fields(line);
+         std::string address, size, name, type, extra;
+         if (!(fields >> address))
+            continue; // Blank or comment
+         if (!(fields >> size >> name >> type) || (fields >> extra))
+            throw path + ":" + std::to_string(number) + ": expected <hex address> <size> <name> code|data";
+         Symbol symbol;
+         symbol.address = (uint16_t)parse(address, 16, 0xffff, path, number);
+         symbol.size = (uint16_t)parse(size, 10, 0x10000 - symbol.address, path, number);
+         symbol.name = name;
+         if (type == "code")
+            symbol.type = CODE;
+         else if (type == "data")
+            symbol.type = DATA;
+         else
+            throw path + ":" + std::to_string(number) + ": type must be code or data, not " + type;
+         symbols.push_back(symbol);
+      }
+      index(path);
+   }
+
+   // The default map when there is one: names are a nicety, not a need
+   bool loadIfPresent(const std::string& path)
+   {
+      if (!std::ifstream(path))
+         return false;
+      load(path);
+      return true;
+   }
+
+   // The shipped map next to the program, else next to the current
+   // directory. Output has no names without it, so `warnings` says so.
+   bool loadDefault(const std::string& program, std::ostream& warnings)
+   {
+      std::string path = defaultPath(program);
+      if (loadIfPresent(path) || loadIfPresent(defaultPath("")))
+         return true;
+      warnings << "No symbols: " << path << " not found, addresses are left unnamed (-symbols <file>)" << std::endl;
+      return false;
+   }
+
+   bool isEmpty() const { return symbols.empty(); }
+   const std::vector<Symbol>& all() const { return symbols; } // By address
+
+   // The symbol of `type` named at exactly `address`, or nullptr
+   const Symbol* at(uint16_t address, Type type) const
+   {
+      for (auto it = lowerBound(address); it != symbols.end() && it->address == address; ++it)
+         if (it->type == type)
+            return &*it;
+      return nullptr;
+   }
+
+   // The nearest symbol at or below `address`, if it reaches that far:
+   // within its size, or up to the next symbol when the size isn't known
+   const Symbol* containing(uint16_t address) const
+   {
+      auto it = std::upper_bound(symbols.begin(), symbols.end(), address,
+         [](uint16_t address, const Symbol& symbol) { return address < symbol.address; });
+      if (it == symbols.begin())
+         return nullptr;
+      --it;
+      return it->size == 0 || address < it->address + it->size ? &*it : nullptr;
+   }
+
+   const Symbol* find(const std::string& name) const
+   {
+      auto it = std::lower_bound(byName.begin(), byName.end(), name,
+         [this](size_t index, const std::string& name) { return symbols[index].name < name; });
+      return it != byName.end() && symbols[*it].name == name ? &symbols[*it] : nullptr;
+   }
+
+   // "PrintMessage", "PrintMessage+3", or empty when nothing covers it
+   std::string describe(uint16_t address) const
+   {
+      const Symbol* symbol = containing(address);
+      if (!symbol)
+         return "";
+      return address == symbol->address ? symbol->name : symbol->name + "+" + std::to_string(address - symbol->address);
+   }
+
+   // Opcodes::NameLookup with the Symbols as context: jump and call targets
+   // by code names, everything else by data names
+   static const char* lookup(uint16_t address, Opcodes::Operand kind, void* context)
+   {
+      const Symbols* symbols = (const Symbols*)context;
+      const Symbol* symbol = symbols ? symbols->at(address, kind == Opcodes::OPERAND_TARGET ? CODE : DATA) : nullptr;
+      return symbol ? symbol->name.c_str() : nullptr;
+   }
+
+private:
+   std::vector<Symbol> symbols; // Sorted by address, code before data at the same address
+   std::vector<size_t> byName;  // Indices into symbols, sorted by name
+
+   std::vector<Symbol>::const_iterator lowerBound(uint16_t address) const
+   {
+      return std::lower_bound(symbols.begin(), symbols.end(), address,
+         [](const Symbol& symbol, uint16_t address) { return symbol.address < address; });
+   }
+
+   static unsigned long parse(const std::string& text, int base, unsigned long maximum, const std::string& path, int number)
+   {
+      size_t end = 0;
+      unsigned long value = 0;
+      try
+      {
+         value = std::stoul(text, &end, base);
+      }
+      catch (...)
+      {
+      }
+      if (end != text.size() || end == 0 || value > maximum)
+         throw path + ":" + std::to_string(number) + ": bad number " + text;
+      return value;
+   }
+
+   void index(const std::string& path)
+   {
+      std::stable_sort(symbols.begin(), symbols.end(),
+         [](const Symbol& a, const Symbol& b) { return a.address < b.address || (a.address == b.address && a.type < b.type); });
+      byName.resize(symbols.size());
+      for (size_t n = 0; n < symbols.size(); n++)
+         byName[n] = n;
+      std::sort(byName.begin(), byName.end(), [this](size_t a, size_t b) { return symbols[a].name < symbols[b].name; });
+      for (size_t n = 1; n < byName.size(); n++)
+         if (symbols[byName[n]].name == symbols[byName[n - 1]].name)
+            throw path + ": " + symbols[byName[n]].name + " is defined twice";
+   }
+};
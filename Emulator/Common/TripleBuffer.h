@@ -0,0 +1,42 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+// Lock-free triple buffer for one producer and one consumer thread.
+//
+// The producer fills back() and publish()es it; the consumer calls update()
+// to take the newest published buffer and reads front(). Neither side ever
+// waits: the producer always has a free buffer to write, frames the
+// consumer did not get to in time are overwritten (dropped), and update()
+// returns false when nothing new arrived (the consumer shows the old one
+// again).
+template<typename T>
+class TripleBuffer
+{
+public:
+   // Producer
+   T& back() { return buffers[backIndex]; }
+   void publish()
+   {
+      backIndex = middle.exchange((uint8_t)(backIndex | FRESH), std::memory_order_acq_rel) & INDEX;
+   }
+
+   // Consumer
+   bool update()
+   {
+      if ((middle.load(std::memory_order_relaxed) & FRESH) == 0)
+         return false;
+      frontIndex = middle.exchange(frontIndex, std::memory_order_acq_rel) & INDEX;
+      return true;
+   }
+   const T& front() { return buffers[frontIndex]; }
+
+private:
+   static const uint8_t INDEX = 3;
+   static const uint8_t FRESH = 4; // Middle holds a buffer the consumer has not seen
+
+   T buffers[3] = {};
+   uint8_t backIndex = 0;                          // Producer only
+   alignas(64) std::atomic<uint8_t> middle{ 1 };   // Swapped by both
+   alignas(64) uint8_t frontIndex = 2;             // Consumer only
+};
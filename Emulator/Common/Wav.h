@@ -0,0 +1,136 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Just enough RIFF/WAVE for the Space Invaders samples and for writing the
+// rendered mix: uncompressed PCM only.
+
+// Loads an 8 or 16 bit PCM file (any channel count, mixed down to mono) and
+// resamples it to `rate` with linear interpolation. Samples are -1..1.
+inline bool loadWav(const char* file, int rate, std::vector<float>& out)
+{
+   std::ifstream stream(file, std::ios::binary);
+   char riff[12];
+   if (!stream.read(riff, sizeof(riff)) || std::memcmp(riff, "RIFF", 4) != 0 || std::memcmp(riff + 8, "WAVE", 4) != 0)
+      return false;
+
+   uint16_t format = 0, channels = 0, bits = 0;
+   uint32_t sourceRate = 0;
+   std::vector<uint8_t> data;
+
+   char id[4];
+   uint32_t size;
+   while (stream.read(id, 4) && stream.read((char*)&size, 4))
+   {
+      if (std::memcmp(id, "fmt ", 4) == 0)
+      {
+         std::vector<uint8_t> fmt(size);
+         if (size < 16 || !stream.read((char*)fmt.data(), size))
+            return false;
+         std::memcpy(&format, &fmt[0], 2);
+         std::memcpy(&channels, &fmt[2], 2);
+         std::memcpy(&sourceRate, &fmt[4], 4);
+         std::memcpy(&bits, &fmt[14], 2);
+      }
+      else if (std::memcmp(id, "data", 4) == 0)
+      {
+         data.resize(size);
+         stream.read((char*)data.data(), size);
+         data.resize((size_t)stream.gcount());
+      }
+      else
+         stream.seekg(size, std::ios::cur);
+      if (size & 1)
+         stream.seekg(1, std::ios::cur); // Chunks are word aligned
+   }
+   if (format != 1 || channels == 0 || sourceRate == 0 || (bits != 8 && bits != 16))
+      return false;
+
+   // Decode and mix down to mono
+   size_t frameBytes = channels * bits / 8;
+   size_t frames = data.size() / frameBytes;
+   std::vector<float> mono(frames);
+   for (size_t frame = 0; frame < frames; frame++)
+   {
+      float sum = 0;
+      for (int channel = 0; channel < channels; channel++)
+      {
+         const uint8_t* p = &data[frame * frameBytes + channel * bits / 8];
+         if (bits == 8)
+            sum += (p[0] - 128) / 128.0f; // 8 bit PCM is unsigned
+         else
+            sum += (int16_t)(p[0] | (p[1] << 8)) / 32768.0f;
+      }
+      mono[frame] = sum / channels;
+   }
+
+   // Resample
+   size_t length = (size_t)((uint64_t)frames * rate / sourceRate);
+   out.resize(length);
+   for (size_t n = 0; n < length; n++)
+   {
+      double position = (double)n * sourceRate / rate;
+      size_t index = (size_t)position;
+      float fraction = (float)(position - index);
+      float a = mono[index];
+      float b = index + 1 < frames ? mono[index + 1] : a;
+      out[n] = a + (b - a) * fraction;
+   }
+   return true;
+}
+
+// Streams 16 bit PCM to a .wav file; the header sizes are patched on close
+class WavWriter
+{
+public:
+   WavWriter(const char* file, int rate, int channels = 1) : stream(file, std::ios::binary), rate(rate), channels(channels)
+   {
+      writeHeader();
+   }
+   ~WavWriter() { close(); }
+
+   void write(const int16_t* samples, size_t count)
+   {
+      stream.write((const char*)samples, count * sizeof(int16_t));
+      bytes += (uint32_t)(count * sizeof(int16_t));
+   }
+
+   void close()
+   {
+      if (!stream.is_open())
+         return;
+      stream.seekp(0);
+      writeHeader();
+      stream.close();
+   }
+
+   uint64_t getSamples() { return bytes / sizeof(int16_t) / channels; }
+
+private:
+   void writeHeader()
+   {
+      uint32_t riffSize = 36 + bytes;
+      uint32_t fmtSize = 16;
+      uint16_t format = 1;
+      uint16_t channelCount = (uint16_t)channels;
+      uint32_t sampleRate = (uint32_t)rate;
+      uint32_t byteRate = rate * channels * 2;
+      uint16_t blockAlign = (uint16_t)(channels * 2);
+      uint16_t bits = 16;
+
+      stream.write("RIFF", 4); stream.write((char*)&riffSize, 4); stream.write("WAVE", 4);
+      stream.write("fmt ", 4); stream.write((char*)&fmtSize, 4);
+      stream.write((char*)&format, 2); stream.write((char*)&channelCount, 2);
+      stream.write((char*)&sampleRate, 4); stream.write((char*)&byteRate, 4);
+      stream.write((char*)&blockAlign, 2); stream.write((char*)&bits, 2);
+      stream.write("data", 4); stream.write((char*)&bytes, 4);
+   }
+
+   std::ofstream stream;
+   int rate;
+   int channels;
+   uint32_t bytes = 0;
+};
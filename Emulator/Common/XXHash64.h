@@ -0,0 +1,75 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+
+// xxHash64 (XXH64), one-shot. Matches the reference implementation, so
+// hashes can be checked with the xxhsum tool.
+namespace XXHash64
+{
+   const uint64_t PRIME1 = 0x9E3779B185EBCA87ull;
+   const uint64_t PRIME2 = 0xC2B2AE3D27D4EB4Full;
+   const uint64_t PRIME3 = 0x165667B19E3779F9ull;
+   const uint64_t PRIME4 = 0x85EBCA77C2B2AE63ull;
+   const uint64_t PRIME5 = 0x27D4EB2F165667C5ull;
+
+   inline uint64_t rotl(uint64_t x, int r) { return (x << r) | (x >> (64 - r)); }
+
+   inline uint64_t read64(const uint8_t* p) { uint64_t v; std::memcpy(&v, p, 8); return v; } // Little endian hosts
+   inline uint32_t read32(const uint8_t* p) { uint32_t v; std::memcpy(&v, p, 4); return v; }
+
+   inline uint64_t round(uint64_t acc, uint64_t input)
+   {
+      acc += input * PRIME2;
+      return rotl(acc, 31) * PRIME1;
+   }
+
+   inline uint64_t merge(uint64_t acc, uint64_t value)
+   {
+      acc ^= round(0, value);
+      return acc * PRIME1 + PRIME4;
+   }
+
+   inline uint64_t hash(const void* data, size_t size, uint64_t seed = 0)
+   {
+      const uint8_t* p = (const uint8_t*)data;
+      const uint8_t* end = p + size;
+      uint64_t h;
+
+      if (size >= 32)
+      {
+         uint64_t v1 = seed + PRIME1 + PRIME2, v2 = seed + PRIME2, v3 = seed, v4 = seed - PRIME1;
+         for (; p + 32 <= end; p += 32)
+         {
+            v1 = round(v1, read64(p));
+            v2 = round(v2, read64(p + 8));
+            v3 = round(v3, read64(p + 16));
+            v4 = round(v4, read64(p + 24));
+         }
+         h = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+         h = merge(h, v1);
+         h = merge(h, v2);
+         h = merge(h, v3);
+         h = merge(h, v4);
+      }
+      else
+         h = seed + PRIME5;
+
+      h += size;
+      for (; p + 8 <= end; p += 8)
+         h = rotl(h ^ round(0, read64(p)), 27) * PRIME1 + PRIME4;
+      if (p + 4 <= end)
+      {
+         h = rotl(h ^ (read32(p) * PRIME1), 23) * PRIME2 + PRIME3;
+         p += 4;
+      }
+      for (; p < end; p++)
+         h = rotl(h ^ (*p * PRIME5), 11) * PRIME1;
+
+      h ^= h >> 33;
+      h *= PRIME2;
+      h ^= h >> 29;
+      h *= PRIME3;
+      h ^= h >> 32;
+      return h;
+   }
+}
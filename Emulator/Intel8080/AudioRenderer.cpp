@@ -0,0 +1,132 @@
+#include "AudioRenderer.h"
+
+#include <algorithm>
+
+const char* const AudioRenderer::SOUND_FILES[SOUNDS] = {
+   "ufo_lowpitch.wav",  // Port 3 bit 0: UFO (looped)
+   "shoot.wav",         // Port 3 bit 1: Player shot
+   "explosion.wav",     // Port 3 bit 2: Player death
+   "invaderkilled.wav", // Port 3 bit 3: Invader death
+   "fastinvader1.wav",  // Port 5 bit 0: Fleet movement 1
+   "fastinvader2.wav",  // Port 5 bit 1: Fleet movement 2
+   "fastinvader3.wav",  // Port 5 bit 2: Fleet movement 3
+   "fastinvader4.wav",  // Port 5 bit 3: Fleet movement 4
+   "ufo_highpitch.wav", // Port 5 bit 4: UFO hit
+};
+
+std::string AudioRenderer::defaultSoundDirectory(const std::string& program)
+{
+   const std::string relative = "../Intel8080GUI/sounds";
+   size_t slash = program.find_last_of("/\\");
+   std::string directory = (slash == std::string::npos ? "" : program.substr(0, slash + 1)) + relative;
+   if (std::ifstream(directory + "/" + SOUND_FILES[0]))
+      return directory;
+   return relative;
+}
+
+AudioRenderer::AudioRenderer(const char* wavFile, const std::string& soundDirectory, int rate, const char* eventFile)
+   : rate(rate), wav(wavFile, rate)
+{
+   for (int sound = 0; sound < SOUNDS; sound++)
+   {
+      std::string path = soundDirectory + "/" + SOUND_FILES[sound];
+      if (!loadWav(path.c_str(), rate, samples[sound]))
+         throw std::string("Failed to load sound effect ") + path;
+   }
+   if (eventFile)
+      events.open(eventFile);
+   buffer.reserve(4096);
+}
+
+void AudioRenderer::attach(IOBus& bus, uint8_t port3, uint8_t port5)
+{
+   bus.mapWrite(port3, [](void* self, uint8_t, uint8_t value) {
+      AudioRenderer* renderer = (AudioRenderer*)self;
+      renderer->latch(renderer->port3, value, 4, 0);
+   }, this);
+   bus.mapWrite(port5, [](void* self, uint8_t, uint8_t value) {
+      AudioRenderer* renderer = (AudioRenderer*)self;
+      renderer->latch(renderer->port5, value, 5, 4);
+   }, this);
+}
+
+void AudioRenderer::latch(uint8_t& latched, uint8_t value, int sounds, int first)
+{
+   uint8_t changed = (latched ^ value) & ((1 << sounds) - 1);
+   latched = value;
+   if (changed == 0 || finished)
+      return;
+
+   uint64_t cycle = clock ? *clock : 0;
+   mixTo(cycle * rate / CLOCK_SPEED);
+   for (int n = 0; n < sounds; n++)
+      if (changed & (1 << n))
+      {
+         bool on = (value & (1 << n)) != 0;
+         if (events.is_open())
+            events << cycle << ' ' << first + n << ' ' << (on ? "on" : "off") << '\n';
+         edge(first + n, on);
+      }
+}
+
+void AudioRenderer::edge(int sound, bool on)
+{
+   if (sound == UFO)
+   {
+      voices.erase(std::remove_if(voices.begin(), voices.end(), [](const Voice& voice) { return voice.sound == UFO; }), voices.end());
+      if (on)
+         voices.push_back({ UFO, 0, true });
+   }
+   else if (on)
+      voices.push_back({ sound, 0, false });
+}
+
+void AudioRenderer::mixTo(uint64_t sample)
+{
+   const float gain = 0.5f; // Headroom for overlapping sounds
+   for (; rendered < sample; rendered++)
+   {
+      float mix = 0;
+      for (size_t n = 0; n < voices.size();)
+      {
+         Voice& voice = voices[n];
+         const std::vector<float>& data = samples[voice.sound];
+         if (voice.position >= data.size())
+         {
+            if (voice.loop && !data.empty())
+               voice.position = 0;
+            else
+            {
+               voices[n] = voices.back();
+               voices.pop_back();
+               continue;
+            }
+         }
+         mix += data[voice.position++];
+         n++;
+      }
+
+      float scaled = std::max(-1.0f, std::min(1.0f, mix * gain));
+      buffer.push_back((int16_t)(scaled * 32767));
+      if (buffer.size() == buffer.capacity())
+         flush();
+   }
+}
+
+void AudioRenderer::flush()
+{
+   wav.write(buffer.data(), buffer.size());
+   buffer.clear();
+}
+
+void AudioRenderer::finish()
+{
+   if (finished)
+      return;
+   if (clock)
+      mixTo(*clock * rate / CLOCK_SPEED);
+   flush();
+   wav.close();
+   events.close();
+   finished = true;
+}
@@ -0,0 +1,69 @@
+#pragma once
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "../Common/IOBus.h"
+#include "../Common/Wav.h"
+
+// Headless sound board: turns port 3/5 bit transitions into a mix of the
+// nine Space Invaders samples, written to a .wav file.
+//
+// Everything runs on emulated time. An edge at cycle c lands on output
+// sample c * rate / CLOCK_SPEED exactly, so a render is reproducible and
+// runs as fast as the emulator does. Like the SDL build, the UFO loops from
+// its rising to its falling edge and every other sound is a one shot started
+// on its rising edge.
+class AudioRenderer
+{
+public:
+   static const uint64_t CLOCK_SPEED = 2'000'000; // 8080 cycles per second
+   static const int SOUNDS = 9;
+   static const int UFO = 0;
+
+   // Sample file names in port bit order: port 3 bits 0-3, then port 5 bits 0-4
+   static const char* const SOUND_FILES[SOUNDS];
+
+   // The GUI's samples, Intel8080GUI/sounds, found from the program's path
+   // (argv[0]) and else from the current directory
+   static std::string defaultSoundDirectory(const std::string& program);
+
+   // soundDirectory holds SOUND_FILES; eventFile (optional) gets one text line per edge
+   AudioRenderer(const char* wavFile, const std::string& soundDirectory, int rate = 44100, const char* eventFile = nullptr);
+   ~AudioRenderer() { finish(); }
+
+   void attach(IOBus& bus, uint8_t port3 = 3, uint8_t port5 = 5);
+   void setClock(const uint64_t* clock) { this->clock = clock; }
+
+   void finish(); // Mix up to the current cycle and close the file
+
+   uint64_t getSamples() { return rendered; }
+
+private:
+   struct Voice
+   {
+      int sound;
+      size_t position;
+      bool loop;
+   };
+
+   void latch(uint8_t& latched, uint8_t value, int sounds, int first);
+   void edge(int sound, bool on);
+   void mixTo(uint64_t sample);
+   void flush();
+
+   int rate;
+   WavWriter wav;
+   std::ofstream events;
+   std::vector<float> samples[SOUNDS];
+   std::vector<Voice> voices;
+   std::vector<int16_t> buffer;
+
+   const uint64_t* clock = nullptr;
+   uint64_t rendered = 0; // Output samples mixed so far
+   bool finished = false;
+
+   uint8_t port3 = 0;
+   uint8_t port5 = 0;
+};
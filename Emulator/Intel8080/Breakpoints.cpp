@@ -0,0 +1,133 @@
+#include "Breakpoints.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+
+int Breakpoints::add(const std::string& condition, bool session)
+{
+   uint16_t pc;
+   if (!Condition(condition, symbols).anchor(pc))
+      throw std::string("A breakpoint condition needs PC==<address> joined with &&, or use a watch: ") + condition;
+   return insert(false, pc, condition, session);
+}
+
+int Breakpoints::addAt(uint16_t pc, const std::string& condition, bool session)
+{
+   return insert(false, pc, condition, session);
+}
+
+int Breakpoints::addWatch(uint16_t address, const std::string& condition, bool session)
+{
+   return insert(true, address, condition, session);
+}
+
+int Breakpoints::addWatch(const std::string& watch, bool session)
+{
+   size_t end = watch.find(' ');
+   std::string address = watch.substr(0, end);
+   size_t condition = end == std::string::npos ? end : watch.find_first_not_of(' ', end);
+   std::string rest = condition == std::string::npos ? "" : watch.substr(condition);
+   if (const Symbols::Symbol* symbol = symbols ? symbols->find(address) : nullptr)
+      return addWatch(symbol->address, rest, session);
+
+   size_t start = address.compare(0, 1, "$") == 0 ? 1 : address.compare(0, 2, "0x") == 0 || address.compare(0, 2, "0X") == 0 ? 2 : 0;
+   if (address.size() == start || address.size() - start > 4
+      || !std::all_of(address.begin() + start, address.end(), [](char c) { return std::isxdigit((unsigned char)c); }))
+      throw std::string(symbols ? "A watch needs a hex address or a symbol: " : "A watch needs a hex address: ") + watch;
+   return addWatch((uint16_t)std::stoul(address.substr(start), nullptr, 16), rest, session);
+}
+
+int Breakpoints::insert(bool watch, uint16_t address, const std::string& condition, bool session)
+{
+   Entry entry = { nextNumber, watch, address, condition.empty() ? Condition() : Condition(condition, symbols), session, 0 };
+   entries.push_back(entry);
+   update();
+   return nextNumber++;
+}
+
+bool Breakpoints::remove(int number)
+{
+   size_t count = entries.size();
+   entries.erase(std::remove_if(entries.begin(), entries.end(), [number](const Entry& entry) { return entry.number == number; }), entries.end());
+   update();
+   return entries.size() != count;
+}
+
+void Breakpoints::removePlain(bool watch, uint16_t address)
+{
+   entries.erase(std::remove_if(entries.begin(), entries.end(), [=](const Entry& entry) {
+      return entry.session && entry.watch == watch && entry.address == address && entry.condition.isEmpty();
+   }), entries.end());
+   update();
+}
+
+void Breakpoints::clear(bool sessionOnly)
+{
+   entries.erase(std::remove_if(entries.begin(), entries.end(), [=](const Entry& entry) { return entry.session || !sessionOnly; }), entries.end());
+   update();
+}
+
+void Breakpoints::update()
+{
+   std::fill(atPC.begin(), atPC.end(), 0);
+   std::fill(watched.begin(), watched.end(), 0);
+   bool watching = false;
+   for (const Entry& entry : entries)
+   {
+      (entry.watch ? watched : atPC)[entry.address] = 1;
+      watching = watching || entry.watch;
+   }
+   // Memory::write only looks while something is watched
+   state->memory->setWatched(watching ? watched.data() : nullptr);
+   state->memory->watchedWriteCount = 0;
+}
+
+const Breakpoints::Entry* Breakpoints::check()
+{
+   Memory* memory = state->memory;
+   const uint16_t* written = memory->watchedWrites;
+   const uint16_t* writtenEnd = written + memory->watchedWriteCount;
+   memory->watchedWriteCount = 0;
+
+   auto& reg = state->Reg;
+   uint8_t flags = reg.f.s << 7 | reg.f.z << 6 | reg.f.a << 4 | reg.f.p << 2 | 1 << 1 | reg.f.c;
+   const int32_t registers[Condition::REGISTERS] = {
+      reg.a, reg.b, reg.c, reg.d, reg.e, reg.h, reg.l,
+      reg.b << 8 | reg.c, reg.d << 8 | reg.e, reg.h << 8 | reg.l, reg.sp, reg.pc, reg.a << 8 | flags,
+      reg.f.c, reg.f.z, reg.f.s, reg.f.p, reg.f.a,
+   };
+
+   for (Entry& entry : entries)
+   {
+      if (entry.watch ? std::find(written, writtenEnd, entry.address) == writtenEnd : entry.address != reg.pc)
+         continue;
+      if (entry.condition.evaluate(registers, memory->memory))
+      {
+         entry.hits++;
+         return &entry;
+      }
+   }
+   return nullptr;
+}
+
+std::string Breakpoints::describe(const Entry& entry) const
+{
+   char address[8];
+   std::snprintf(address, sizeof(address), "%04x", entry.address);
+   std::string text = (entry.watch ? "Watch " : "Breakpoint ") + std::to_string(entry.number) + " at " + address;
+   std::string name = symbols ? symbols->describe(entry.address) : "";
+   if (!name.empty())
+      text += " (" + name + ")";
+   if (!entry.condition.isEmpty())
+      text += " if " + entry.condition.getText();
+   return text;
+}
+
+void Breakpoints::list(std::ostream& stream) const
+{
+   if (entries.empty())
+      stream << "No breakpoints or watches" << std::endl;
+   for (const Entry& entry : entries)
+      stream << describe(entry) << " (" << entry.hits << (entry.hits == 1 ? " hit)" : " hits)") << std::endl;
+}
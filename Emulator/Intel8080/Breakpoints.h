@@ -0,0 +1,73 @@
+#pragma once
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "State8080.h"
+#include "../Common/Condition.h"
+#include "../Common/Symbols.h"
+
+// Breakpoints and watches, plain or with a Condition, shared by the run
+// loop (-break, -watch) and the gdb stub (Z packets, monitor commands).
+//
+// A breakpoint belongs to one address, given or taken from its condition's
+// PC==n, and its condition is only evaluated when the CPU is about to run
+// the instruction there. A watch is evaluated after an instruction writes
+// its address. Anywhere else the run loop pays a byte lookup and a flag
+// test per instruction, and nothing at all while there are no entries.
+//
+// With Symbols, conditions and watches can name addresses ("PC==PrintMessage",
+// "isrDelay") and entries are described with the names.
+class Breakpoints
+{
+public:
+   struct Entry
+   {
+      int number;
+      bool watch;        // After writes to address, rather than before running it
+      uint16_t address;
+      Condition condition;
+      bool session;      // Set by the gdb client, removed when it goes
+      uint64_t hits;
+   };
+
+   explicit Breakpoints(State8080* state, const Symbols* symbols = nullptr) : state(state), symbols(symbols) {}
+   ~Breakpoints() { state->memory->setWatched(nullptr); }
+
+   // Throw a std::string for a bad condition. Return the entry's number.
+   int add(const std::string& condition, bool session = false); // Anchored at the condition's PC==n
+   int addAt(uint16_t pc, const std::string& condition, bool session = false);
+   int addWatch(uint16_t address, const std::string& condition, bool session = false);
+   int addWatch(const std::string& watch, bool session = false); // "<hex address or symbol> [condition]"
+
+   bool remove(int number);
+   // The plain session breakpoint or watch at `address`, for gdb's z packets
+   void removePlain(bool watch, uint16_t address);
+   void clear(bool sessionOnly);
+
+   bool isArmed() const { return !entries.empty(); }
+
+   // Nonzero at every address with a breakpoint. The run loop keeps this
+   // and Memory::watchedWriteCount at hand and only calls check() when the
+   // next instruction is at a breakpoint or a watched address was written.
+   const uint8_t* getStops() const { return atPC.data(); }
+
+   // The entry that stops here, if any: a breakpoint at PC or a watch on
+   // any address the last instruction wrote, whose condition holds
+   const Entry* check();
+
+   void list(std::ostream& stream) const;
+   std::string describe(const Entry& entry) const;
+
+private:
+   int insert(bool watch, uint16_t address, const std::string& condition, bool session);
+   void update(); // Rebuilds the address maps after a change
+
+   State8080* state;
+   const Symbols* symbols;
+   std::vector<Entry> entries;
+   std::vector<uint8_t> atPC = std::vector<uint8_t>(0x10000);
+   std::vector<uint8_t> watched = std::vector<uint8_t>(0x10000);
+   int nextNumber = 1;
+};
@@ -0,0 +1,97 @@
+#include "CPM.h"
+#include "Memory.h"
+#include "State8080.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <iostream>
+
+// Handles the call trapped at CPM_BDOS, then returns to the caller like the
+// RET at the end of the real BDOS would. Returns false on a system reset.
+static bool bdos(State8080* state, CPMResult& result, bool echo)
+{
+   Memory* memory = state->memory;
+   std::string text;
+
+   switch (state->Reg.c)
+   {
+   case 0: // System reset
+      return false;
+   case 2: // Console output
+      text = (char)state->Reg.e;
+      break;
+   case 9: // Print string
+   {
+      uint16_t address = (state->Reg.d << 8) | state->Reg.e;
+      for (int n = 0; n < 0x10000 && memory->memory[address] != '$'; n++)
+         text += (char)memory->memory[address++];
+      break;
+   }
+   default: // Everything else is a no-op for the test programs
+      break;
+   }
+
+   result.output += text;
+   if (echo)
+      std::cout << text << std::flush;
+
+   // RET
+   state->Reg.pc = memory->memory[state->Reg.sp] | (memory->memory[(uint16_t)(state->Reg.sp + 1)] << 8);
+   state->Reg.sp += 2;
+   return true;
+}
+
+static bool contains(const std::string& text, const std::string& word)
+{
+   auto it = std::search(text.begin(), text.end(), word.begin(), word.end(),
+      [](char a, char b) { return std::toupper((unsigned char)a) == b; });
+   return it != text.end();
+}
+
+CPMResult runCPM(char* file, bool echo, uint64_t maxCycles)
+{
+   CPMResult result;
+   result.program = file;
+
+   Memory* memory = new Memory(file, CPM_TPA, 0);
+   memory->memory[CPM_BDOS + 0] = 0xC3; // JMP CPM_BDOS_TOP, only its operand matters since the call is trapped
+   memory->memory[CPM_BDOS + 1] = (CPM_BDOS_TOP >> 0) & 0xff;
+   memory->memory[CPM_BDOS + 2] = (CPM_BDOS_TOP >> 8) & 0xff;
+   memory->memory[CPM_BDOS_TOP] = 0xC9; // RET
+
+   State8080* state = new State8080(memory);
+   state->Reg.pc = CPM_TPA;
+   state->Reg.sp = CPM_BDOS_TOP; // Returning from the program pops CPM_WARM_BOOT
+   memory->memory[--state->Reg.sp] = (CPM_WARM_BOOT >> 8) & 0xff;
+   memory->memory[--state->Reg.sp] = (CPM_WARM_BOOT >> 0) & 0xff;
+
+   auto start = std::chrono::steady_clock::now();
+   while (!state->isStopped())
+   {
+      if (state->Reg.pc == CPM_WARM_BOOT)
+      {
+         result.finished = true;
+         break;
+      }
+      if (state->Reg.pc == CPM_BDOS && !bdos(state, result, echo))
+      {
+         result.finished = true;
+         break;
+      }
+
+      result.cycles += state->Emulate8080Op();
+      result.instructions++;
+
+      if (maxCycles && result.cycles >= maxCycles)
+         break;
+   }
+   result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+   // The test programs all report problems with one of these words
+   result.passed = result.finished && !contains(result.output, "ERROR") && !contains(result.output, "FAIL");
+
+   delete state;
+   delete memory;
+   return result;
+}
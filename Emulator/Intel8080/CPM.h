@@ -0,0 +1,29 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+// Minimal CP/M machine for running the classic 8080 test programs
+// (TST8080, 8080PRE, CPUTEST, 8080EXM, ...):
+//    64K flat RAM, program loaded at 0x100
+//    BDOS call at 0x0005 trapped; function 2 (print E) and 9 (print $-terminated string at DE)
+//    Warm boot (jump to 0x0000, or BDOS function 0) ends the run
+
+#define CPM_WARM_BOOT 0x0000
+#define CPM_BDOS      0x0005
+#define CPM_TPA       0x0100
+#define CPM_BDOS_TOP  0xFE00 // Reported at 0x0006 so programs can set up their stack below it
+
+struct CPMResult
+{
+   std::string program;
+   std::string output;       // Everything printed through the BDOS
+   bool finished = false;    // Reached warm boot (rather than HLT or the cycle limit)
+   bool passed = false;
+   uint64_t cycles = 0;
+   uint64_t instructions = 0;
+   double seconds = 0;
+};
+
+// Runs one .COM file. echo copies console output to std::cout as it is
+// produced; maxCycles of 0 means no limit.
+CPMResult runCPM(char* file, bool echo = true, uint64_t maxCycles = 0);
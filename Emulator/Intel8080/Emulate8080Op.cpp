@@ -1,5 +1,6 @@
 #include "State8080.h"
 #include "OpcodeFunctions.h"
+#include "../Common/Opcodes.h"
 #include <algorithm>
 
 #include <iostream>
@@ -15,12 +16,20 @@ void State8080::generateInterrupt(uint8_t opcode)
 {
    interruptOpcode = opcode;
    interruptRequested = true;
+   instrumentation.interruptRequested();
 }
 
 int State8080::Emulate8080Op()
 {
-   if (stopped) // Halt state
-      return 0;
+   if (stopped) // Halt state: idle until an interrupt
+   {
+      if (!interruptRequested || !interruptEnabled)
+      {
+         instrumentation.halted(HALT_CYCLES);
+         return HALT_CYCLES;
+      }
+      stopped = false;
+   }
 
    unsigned char opcode;
 
@@ -30,31 +39,37 @@ int State8080::Emulate8080Op()
       interruptRequested = false;
       opcode = interruptOpcode; // Fetch interrupt opcode
       this->updatePC = false;
+      instrumentation.interruptTaken(opcode);
    }
    else
    {
-      opcode = memory->read(Reg.pc); // Fetch normal opcode
+      opcode = memory->fetch(Reg.pc); // Fetch normal opcode
       this->updatePC = true;
    }
 
-   this->hitCount[opcode]++;
+   int cycles = execute(opcode);
+   instrumentation.instruction(opcode, cycles);
+   return cycles;
+}
+
+int State8080::execute(uint8_t opcode)
+{
+   const Opcodes::Info& info = Opcodes::TABLE[opcode]; // Cycle counts
 
    switch (opcode)
    {          // Opcode Instruction size  flags          function
    // CARRY BIT INSTRUCTIONS: CMC, STC
    case 0x3F: // 0x3f   CMC         1     CY             CY <- !CY
    {
-      // 4 cycles
       Reg.f.c = !Reg.f.c;
       this->incrementPC(1);
-      return 4;
+      return info.cycles;
    }
    case 0x37: // 0x37   STC         1     CY             CY <- 1
    {
-      // 4 cycles
       Reg.f.c = 1;
       this->incrementPC(1);
-      return 4;
+      return info.cycles;
    }
 
    // SINGLE REGISTER INSTRUCTIONS: INR, DCR, CMA, DAA
@@ -67,10 +82,9 @@ int State8080::Emulate8080Op()
    case 0x34: // 0x34   INR M       1     Z S P AC       (HL) <- (HL)+1
    case 0x3C: // 0x3c   INR A       1     Z S P AC       A <- A+1
    {
-      // 5 cycles
       INR(this, CODE_1);
       this->incrementPC(1);
-      return 5;
+      return info.cycles;
    }
 
    case 0x05: // 0x05   DCR B       1     Z S P AC       B <- B-1
@@ -82,33 +96,29 @@ int State8080::Emulate8080Op()
    case 0x35: // 0x35   DCR M       1     Z S P AC       (HL) <- (HL)-1
    case 0x3D: // 0x3d   DCR A       1     Z S P AC       A <- A-1
    {
-      // 5 cycles
       DCR(this, CODE_1);
       this->incrementPC(1);
-      return 5;
+      return info.cycles;
    }
 
    case 0x2F: // 0x2f   CMA         1                    A <- !A
    {
-      // 4 cycles
       Reg.a = ~Reg.a;
       this->incrementPC(1);
-      return 4;
+      return info.cycles;
    }
    case 0x27: // 0x27   DAA         1     Z S P CY AC    special
    {
-      // 4 cycles
       DAA(this);
       this->incrementPC(1);
-      return 4;
+      return info.cycles;
    }
 
    // NOP INSTRUCTION
    case 0x00: // 0x00   NOP         1
    {
-      // 4 cycles
       this->incrementPC(1);
-      return 4;
+      return info.cycles;
    }
 
    // DATA TRANSFER INSTRUCTIONS: MOV, STAX, LDAX
@@ -176,50 +186,40 @@ int State8080::Emulate8080Op()
    case 0x7E: // 0x7e   MOV AM      1                    A <- (HL)
    case 0x7F: // 0x7f   MOV AA      1                    A <- A
    {
-      // ALL MOV opcodes
-      // If dst or src = 110B, 7 cycles, else 5 cycles
-
       uint8_t dst = CODE_1; // 01DDDSSS
       uint8_t src = CODE_2; // 01DDDSSS
       //getRegister(dst) = getRegister(src);
       setRegister(dst, getRegister(src));
 
       this->incrementPC(1);
-      if ((dst == 6) || (src == 6))
-         return 7;
-      else
-         return 5;
+      return info.cycles;
    }
 
    case 0x02: // 0x02   STAX B      1                    (BC) <- A
    {
-      // 7 cycles
       memory->write((Reg.b << 8) | (Reg.c), Reg.a);
       this->incrementPC(1);
-      return 7;
+      return info.cycles;
    }
    case 0x12: // 0x12   STAX D      1                    (DE) <- A
    {
-      // 7 cycles
       memory->write((Reg.d << 8) | (Reg.e), Reg.a);
 
       this->incrementPC(1);
-      return 7;
+      return info.cycles;
    }
 
    case 0x0A: // 0x0a   LDAX B      1                    A <- (BC)
    {
-      // 7 cycles
       Reg.a = memory->read((Reg.b << 8) | (Reg.c));
       this->incrementPC(1);
-      return 7;
+      return info.cycles;
    }
    case 0x1A: // 0x1a   LDAX D      1                    A <- (DE)
    {
-      // 7 cycles
       Reg.a = memory->read((Reg.d << 8) | (Reg.e));
       this->incrementPC(1);
-      return 7;
+      return info.cycles;
    }
 
    // REGISTER OR MEMORY TO ACCUMULATOR INSTRUCTIONS: ADD, ADC, SUB, SBB, ANA, XRA, ORA, CMP
@@ -288,7 +288,6 @@ int State8080::Emulate8080Op()
    case 0xBE: // 0xbe   CMP M       1     Z S P CY AC    A - (HL)
    case 0xBF: // 0xbf   CMP A       1     Z S P CY AC    A - A
    {
-      // 4 cycles
       
       // Get which math operation is performed
       uint8_t op = CODE_1;
@@ -301,16 +300,12 @@ int State8080::Emulate8080Op()
 
       // Update program counter
       this->incrementPC(1);
-      if (reg == 6)
-         return 7; // ALU M
-      else
-         return 4; // ALU r
+      return info.cycles;
    }
 
    // ROTATE ACCUMULATOR INSTRUCTIONS: RLC, RRC, RAL, RAR
    case 0x07: // 0x07   RLC         1     CY             A = A << 1; bit 0 = prev bit 7; CY = prev bit 7
    {
-      // 4 cycles
 
       /// Carry bit is set equal to the high-order bit of the accumulator
       Reg.f.c = ((Reg.a & 0x80) == 0x80);
@@ -319,11 +314,10 @@ int State8080::Emulate8080Op()
       Reg.a = ((Reg.a << 1) & 0xfe) | ((Reg.a >> 7) & 0x01);
 
       this->incrementPC(1);
-      return 4;
+      return info.cycles;
    }
    case 0x0F: // 0x0f   RRC         1     CY             A = A >> 1; bit 7 = prev bit 0; CY = prev bit 0
    {
-      // 4 cycles
 
       /// Carry bit is set equal to the low-order bit of the accumulator
       Reg.f.c = ((Reg.a & 0x01) == 0x01);
@@ -332,11 +326,10 @@ int State8080::Emulate8080Op()
       Reg.a = ((Reg.a >> 1) & 0x7f) | ((Reg.a << 7) & 0x80);
 
       this->incrementPC(1);
-      return 4;
+      return info.cycles;
    }
    case 0x17: // 0x17   RAL         1     CY             A = A << 1; bit 0 = prev CY; CY = prev bit 7
    {
-      // 4 cycles
       uint8_t carry = Reg.f.c; // Copy of carry bit
 
       /// High-order bit of the accumulator replaces the Carry bit
@@ -349,12 +342,11 @@ int State8080::Emulate8080Op()
       Reg.a = (Reg.a & 0xfe) | (carry << 0);
 
       this->incrementPC(1);
-      return 4;
+      return info.cycles;
       // * Originally high-order, but I followed low-order to match diagram depicted.
    }
    case 0x1F: // 0x1f   RAR         1     CY             A = A >> 1; bit 7 = prev bit 7; CY = prev bit 0
    {
-      // 4 cycles
       uint8_t carry = Reg.f.c; // Copy of carry bit
 
       /// Low-order bit of the accumulator replaces the Carry bit
@@ -367,7 +359,7 @@ int State8080::Emulate8080Op()
       Reg.a = (Reg.a & 0x7f) | (carry << 7);
 
       this->incrementPC(1);
-      return 4;
+      return info.cycles;
    }
 
    // REGISTER PAIR INSTRUCTIONS: PUSH, POP, DAD INX, DCX, XCHG, XTHL, SPHL
@@ -375,28 +367,24 @@ int State8080::Emulate8080Op()
    {
       // From manual STACK PUSH OPERATION
 
-      // 11 cycles
       PUSH(this, Reg.b, Reg.c);
       this->incrementPC(1);
-      return 11;
+      return info.cycles;
    }
    case 0xD5: // 0xd5   PUSH D      1                    (sp-2)<-E; (sp-1)<-D; sp <- sp - 2
    {
-      // 11 cycles
       PUSH(this, Reg.d, Reg.e);
       this->incrementPC(1);
-      return 11;
+      return info.cycles;
    }
    case 0xE5: // 0xe5   PUSH H      1                    (sp-2)<-L; (sp-1)<-H; sp <- sp - 2
    {
-      // 11 cycles
       PUSH(this, Reg.h, Reg.l);
       this->incrementPC(1);
-      return 11;
+      return info.cycles;
    }
    case 0xF5: // 0xf5   PUSH PSW    1                    (sp-2)<-flags; (sp-1)<-A; sp <- sp - 2
    {
-      // 11 cycles
       PUSH(this, Reg.a,
          (Reg.f.s << 7) |
          (Reg.f.z << 6) |
@@ -407,33 +395,29 @@ int State8080::Emulate8080Op()
          (1 << 1)       |
          (Reg.f.c << 0));
       this->incrementPC(1);
-      return 11;
+      return info.cycles;
    }
 
    case 0xC1: // 0xc1   POP B       1                    C <- (sp); B <- (sp+1); sp <- sp+2
    {
-      // 10 cycles
       POP(this, Reg.b, Reg.c);
       this->incrementPC(1);
-      return 10;
+      return info.cycles;
    }
    case 0xD1: // 0xd1   POP D       1                    E <- (sp); D <- (sp+1); sp <- sp+2
    {
-      // 10 cycles
       POP(this, Reg.d, Reg.e);
       this->incrementPC(1);
-      return 10;
+      return info.cycles;
    }
    case 0xE1: // 0xe1   POP H       1                    L <- (sp); H <- (sp+1); sp <- sp+2
    {
-      // 10 cycles
       POP(this, Reg.h, Reg.l);
       this->incrementPC(1);
-      return 10;
+      return info.cycles;
    }
    case 0xF1: // 0xf1   POP PSW     1     Z S P CY AC    flags <- (sp); A <- (sp+1); sp <- sp+2
    {
-      // 10 cycles
       //uint8_t flags = memory->read(Reg.sp + 0); // Storage for flags register
       uint8_t flags = memory->memory[Reg.sp + 0];
       POP(this, Reg.a, flags);
@@ -449,151 +433,133 @@ int State8080::Emulate8080Op()
       Reg.f.c = ((flags & (1 << 0)) == (1 << 0)); // Carry bit
 
       this->incrementPC(1);
-      return 10;
+      return info.cycles;
    }
    case 0x09: // 0x09   DAD B       1     CY             HL = HL + BC
    {
-      // 10 cycles
       DAD(this, (uint32_t)(Reg.b << 8) | (uint32_t)Reg.c);
       this->incrementPC(1);
-      return 10;
+      return info.cycles;
    }
    case 0x19: // 0x19   DAD D       1     CY             HL = HL + DE
    {
-      // 10 cycles
       DAD(this, (uint32_t)(Reg.d << 8) | (uint32_t)Reg.e);
       this->incrementPC(1);
-      return 10;
+      return info.cycles;
    }
    case 0x29: // 0x29   DAD H       1     CY             HL = HL + HL
    {
-      // 10 cycles
       DAD(this, (uint32_t)(Reg.h << 8) | (uint32_t)Reg.l);
       this->incrementPC(1);
-      return 10;
+      return info.cycles;
    }
    case 0x39: // 0x39   DAD SP      1     CY             HL = HL + SP
    {
-      // 10 cycles
       DAD(this, (uint32_t)Reg.sp);
       this->incrementPC(1);
-      return 10;
+      return info.cycles;
    }
 
    case 0x03: // 0x03   INX B       1                    BC <- BC + 1
    {
-      // 5 cycles
       INX(this, Reg.b, Reg.c);
       this->incrementPC(1);
-      return 5;
+      return info.cycles;
    }
    case 0x13: // 0x13   INX D       1                    DE <- DE + 1
    {
-      // 5 cycles
       INX(this, Reg.d, Reg.e);
       this->incrementPC(1);
-      return 5;
+      return info.cycles;
    }
    case 0x23: // 0x23   INX H       1                    HL <- HL + 1
    {
-      // 5 cycles
       INX(this, Reg.h, Reg.l);
       //Reg.pc = Reg.pc + 1;
       this->incrementPC(1);
-      return 5;
+      return info.cycles;
    }
    case 0x33: // 0x33   INX SP      1                    SP = SP + 1
    {
-      // 5 cycles
       Reg.sp = Reg.sp + 1;
       this->incrementPC(1);
-      return 5;
+      return info.cycles;
    }
 
    case 0x0B: // 0x0b   DCX B       1                    BC = BC - 1
    {
-      // 5 cycles
       DCX(this, Reg.b, Reg.c);
       this->incrementPC(1);
-      return 5;
+      return info.cycles;
    }
    case 0x1B: // 0x1b   DCX D       1                    DE = DE - 1
    {
-      // 5 cycles
       DCX(this, Reg.d, Reg.e);
       this->incrementPC(1);
-      return 5;
+      return info.cycles;
    }
    case 0x2B: // 0x2b   DCX H       1                    HL = HL - 1
    {
-      // 5 cycles
       DCX(this, Reg.h, Reg.l);
       this->incrementPC(1);
-      return 5;
+      return info.cycles;
    }
    case 0x3B: // 0x3b   DCX SP      1                    SP = SP - 1
    {
-      // 5 cycles
       Reg.sp = Reg.sp - 1;
       this->incrementPC(1);
-      return 5;
+      return info.cycles;
    }
 
    case 0xEB: // 0xeb   XCHG        1                    H <-> D; L <-> E
    {
-      // 5 cycles
       std::swap(Reg.h, Reg.d);
       std::swap(Reg.l, Reg.e);
       this->incrementPC(1);
-      return 5;
+      return info.cycles;
    }
    case 0xE3: // 0xe3   XTHL        1                    L <-> (SP); H <-> (SP+1)
    {
-      // 18 cycles (Longest operation!)
+      // Longest operation!
       uint8_t temp;
       
       temp = Reg.l; Reg.l = memory->read(Reg.sp + 0); memory->write(Reg.sp + 0, temp); //std::swap(Reg.l, memory->read(Reg.sp + 0));
       temp = Reg.h; Reg.h = memory->read(Reg.sp + 1); memory->write(Reg.sp + 1, temp); //std::swap(Reg.h, memory->read(Reg.sp + 1));
 
       this->incrementPC(1);
-      return 18;
+      return info.cycles;
    }
    case 0xF9: // 0xf9   SPHL        1                    SP=HL
    {
-      // 5 cycles
       Reg.sp = (Reg.h << 8) | (Reg.l);
       this->incrementPC(1);
-      return 5;
+      return info.cycles;
    }
 
    // IMMEDIATE INSTRUCTIONS: LXI, MVI, ADI, ACI, SUI, SBI, ANI, XRI, ORI, CPI
    case 0x01: // 0x01   LXI BD16    3                    B <- byte 3 C <- byte 2
    {
-      // 10 cycles
       LXI(this, Reg.b, Reg.c);
       this->incrementPC(3);
-      return 10;
+      return info.cycles;
    }
    case 0x11: // 0x11   LXI DD16    3                    D <- byte 3 E <- byte 2
    {
-      // 10 cycles
       LXI(this, Reg.d, Reg.e);
       this->incrementPC(3);
-      return 10;
+      return info.cycles;
    }
    case 0x21: // 0x21   LXI HD16    3                    H <- byte 3 L <- byte 2
    {
-      // 10 cycles
       LXI(this, Reg.h, Reg.l);
       this->incrementPC(3);
-      return 10;
+      return info.cycles;
    }
    case 0x31: // 0x31   LXI SP D16  3                    SP.hi <- byte 3 SP.lo <- byte 2
    {
-      // 10 cycles
       Reg.sp = address();
       this->incrementPC(3);
-      return 10;
+      return info.cycles;
    }
 
    case 0x06: // 0x06   MVI B D8    2                    B <- byte 2
@@ -605,11 +571,10 @@ int State8080::Emulate8080Op()
    case 0x36: // 0x36   MVI M D8    2                    (HL) <- byte 2
    case 0x3E: // 0x3e   MVI A D8    2                    A <- byte 2
    {
-      // 7 cycles
       //getRegister(CODE_1) = immediate(1);
       setRegister(CODE_1, immediate(1));
       this->incrementPC(2);
-      return 7;
+      return info.cycles;
    }
 
    case 0xC6: // 0xc6   ADI D8      2     Z S P CY AC    A <- A + byte
@@ -621,62 +586,55 @@ int State8080::Emulate8080Op()
    case 0xF6: // 0xf6   ORI D8      2     Z S P CY AC    A <- A | data
    case 0xFE: // 0xfe   CPI D8      2     Z S P CY AC    A - data
    {
-      // 7 cycles
       uint8_t op = CODE_1;
       math[op](this, immediate());
 
       this->incrementPC(2);
-      return 7;
+      return info.cycles;
    }
 
    // DIRECT ADDRESSING INSTRUCTIONS: STA, LDA, SHLD, LHLD
    case 0x32: // 0x32   STA adr     3                    (adr) <- A
    {
-      // 13 cycles
       uint16_t adr = address();
       memory->write(adr, Reg.a);
       this->incrementPC(3);
-      return 13;
+      return info.cycles;
    }
    case 0x3A: // 0x3a   LDA adr     3                    A <- (adr)
    {
-      // 13 cycles
       uint16_t adr = address();
       Reg.a = memory->read(adr);
       this->incrementPC(3);
-      return 13;
+      return info.cycles;
    }
    case 0x22: // 0x22   SHLD adr    3                    (adr) <-L; (adr+1)<-H
    {
-      // 16 cycles
       uint16_t adr = address();
       memory->write(adr + 0, Reg.l);
       memory->write(adr + 1, Reg.h);
       this->incrementPC(3);
-      return 16;
+      return info.cycles;
    }
    case 0x2A: // 0x2a   LHLD adr    3                    L <- (adr); H<-(adr+1)
    {
-      // 16 cycles
       uint16_t adr = address();
       Reg.l = memory->read(adr + 0);
       Reg.h = memory->read(adr + 1);
       this->incrementPC(3);
-      return 16;
+      return info.cycles;
    }
 
    // JUMP INSTRUCTIONS: PCHL, JMP, JC, JNC, JZ, JNZ, JM, JP, JPE, JPO
    case 0xE9: // 0xe9   PCHL        1                    pc.hi <- H; pc.lo <- L
    {
-      // 5 cycles
       Reg.pc = (Reg.h << 8) | (Reg.l << 0);
-      return 5;
+      return info.cycles;
    }
    case 0xC3: // 0xc3   JMP adr     3                    pc <- adr
    {
-      // 10 cycles
       Reg.pc = address();
-      return 10;
+      return info.cycles;
    }
    case 0xDA: // 0xda   JC  adr     3                    if C  pc <- adr
    case 0xD2: // 0xd2   JNC adr     3                    if NC pc <- adr
@@ -687,22 +645,20 @@ int State8080::Emulate8080Op()
    case 0xEA: // 0xea   JPE adr     3                    if PE pc <- adr
    case 0xE2: // 0xe2   JPO adr     3                    if PO pc <- adr
    {
-      // 10 cycles
       uint16_t addr = address();
       int test = CODE_1;
       if (tests[test](this))
          Reg.pc = addr;
       else
          this->incrementPC(3);
-      return 10;
+      return info.cycles;
    }
 
    // CALL SUBROUTINE INSTRUCTIONS: CALL, CC, CNC, CZ, CNZ, CM, CP, CPE, CPO
    case 0xCD: // 0xcd   CALL adr    3                    (SP-1) <- pc.hi; (SP-2) <- pc.lo; SP <- SP + 2; pc = adr
    {
-      // 17 cycles
       CALL(this, address());
-      return 17;
+      return info.cycles;
    }
    case 0xDC: // 0xdc   CC  adr     3                    if C  CALL adr
    case 0xD4: // 0xd4   CNC adr     3                    if NC CALL adr
@@ -713,26 +669,24 @@ int State8080::Emulate8080Op()
    case 0xEC: // 0xec   CPE adr     3                    if PE CALL adr
    case 0xE4: // 0xe4   CPO adr     3                    if PO CALL adr
    {
-      // 11/17 cycles
       uint16_t addr = address();
       if (tests[CODE_1](this))
       {
          CALL(this, addr);
-         return 17;
+         return info.taken;
       }
       else
       {
          this->incrementPC(3);
-         return 11;
+         return info.cycles;
       }
    }
 
    // RETURN FROM SUBROUTINE INSTRUCTIONS: RET, RN, RNC, RZ, RNZ, RM, RP, RPE, RPO
    case 0xC9: // 0xc9   RET         1                    pc.lo <- (sp); pc.hi <- (sp + 1); SP <- SP + 2
    {
-      // 10 cycles
       RET(this);
-      return 10;
+      return info.cycles;
    }
    case 0xD8: // 0xd8   RC          1                    if C  RET
    case 0xD0: // 0xd0   RNC         1                    if NC RET
@@ -743,16 +697,15 @@ int State8080::Emulate8080Op()
    case 0xE8: // 0xe8   RPE         1                    if PE RET
    case 0xE0: // 0xe0   RPO         1                    if PO RET
    {
-      // 5/11 cycles
       if (tests[CODE_1](this))
       {
          RET(this);
-         return 11;
+         return info.taken;
       }
       else
       {
          this->incrementPC(1);
-         return 5;
+         return info.cycles;
       }
    }
 
@@ -766,75 +719,64 @@ int State8080::Emulate8080Op()
    case 0xF7: // 0xf7   RST 6       1                    CALL $30
    case 0xFF: // 0xff   RST 7       1                    CALL $38
    {
-      // 11 cycles
       RST(this, opcode & 0x38); // opcode & 0x38 == (CODE_1) << 3
-      return 11;
+      return info.cycles;
    }
 
    // INTERRUPT FLIP-FLOP INSTRUCTIONS
    case 0xFB: // 0xfb   EI          1                    special
    {
-      // 4 cycles
       // Enable Interrupts
       interruptEnabled = true;
       this->incrementPC(1);
-      return 4;
+      return info.cycles;
    }
    case 0xF3: // 0xf3   DI          1                    special
    {
-      // 4 cycles
       // Disable Interrupts
       interruptEnabled = false;
       this->incrementPC(1);
-      return 4;
+      return info.cycles;
    }
 
    // INPUT/OUTPUT INSTRUCTIONS: IN, OUT
    case 0xDB: // 0xdb   IN  D8      2                    special
    {
-      // 10 cycles
       // Read input port into A
       uint8_t port = immediate();
+      instrumentation.portRead(port);
       Reg.a = io->read(port);
-      if (enablePrint)
-         std::cout << std::endl << std::hex
-         << std::setw(2) << (int)port
-         << std::setw(2) << (int)port << " "
-         << std::setw(2) << (int)Reg.a << " I";
+      if (trace)
+         trace->record(port, Reg.a, TRACE_IN);
       this->incrementPC(2);
-      return 10;
+      return info.cycles;
    }
    case 0xD3: // 0xd3   OUT D8      2                    special
    {
-      // 10 cycles
       // Write A to ouput port
       uint8_t port = immediate();
+      instrumentation.portWrite(port);
       io->write(port, Reg.a);
-      if (enablePrint)
-         std::cout << std::endl << std::hex
-         << std::setw(2) << (int)port
-         << std::setw(2) << (int)port << " "
-         << std::setw(2) << (int)Reg.a << " O";
+      if (trace)
+         trace->record(port, Reg.a, TRACE_OUT);
       this->incrementPC(2);
-      return 10;
+      return info.cycles;
    }
 
    // HLT HALT INSTRUCTION
    case 0x76: // 0x76   HLT         1                    special
    {
       // Halt processor
-      // 7 cycles
       this->incrementPC(1);
       stopped = true;
-      return 7;
+      return info.cycles;
    }
 
    // unused
    default: // 0x08, 0x10, 0x18, 0x20, 0x28, 0x30, 0x38, 0xcb, 0xd9, 0xdd, 0xed, 0xfd
    {
-      // 4 cycles
       this->incrementPC(1);
-      return 4;
+      return info.cycles;
    }
    }
 
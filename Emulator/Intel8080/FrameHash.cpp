@@ -0,0 +1,71 @@
+#include "FrameHash.h"
+
+#include <cinttypes>
+#include <cstdio>
+
+#include "../Common/XXHash64.h"
+
+FrameHashLog::FrameHashLog(const char* file, Mode mode) : mode(mode)
+{
+   if (mode == RECORD)
+   {
+      out.open(file);
+      if (!out)
+         throw std::string("Can't write ") + file;
+      out << "# frame vram(2400-3fff) ram(2000-23ff), xxh64\n";
+   }
+   else
+   {
+      in.open(file);
+      if (!in)
+         throw std::string("Can't read ") + file;
+   }
+}
+
+FrameHashLog::Hashes FrameHashLog::hash(const uint8_t* memory)
+{
+   return { XXHash64::hash(&memory[0x2400], 0x1c00), XXHash64::hash(&memory[0x2000], 0x400) };
+}
+
+bool FrameHashLog::frame(const uint8_t* memory)
+{
+   actual = hash(memory);
+   uint64_t number = frames++;
+
+   if (mode == RECORD)
+   {
+      char line[64];
+      std::snprintf(line, sizeof(line), "%" PRIu64 " %016" PRIx64 " %016" PRIx64 "\n", number, actual.vram, actual.ram);
+      out << line;
+      return true;
+   }
+
+   std::string line;
+   do
+   {
+      if (!std::getline(in, line))
+      {
+         ended = true;
+         return false;
+      }
+      lineNumber++;
+   } while (line.empty() || line[0] == '#');
+   uint64_t golden;
+   if (std::sscanf(line.c_str(), "%" SCNu64 " %" SCNx64 " %" SCNx64, &golden, &expected.vram, &expected.ram) != 3)
+      badLine = "line " + std::to_string(lineNumber) + " is not \"<frame> <vram hash> <ram hash>\"";
+   else if (golden != number)
+      badLine = "line " + std::to_string(lineNumber) + " is frame " + std::to_string(golden);
+   if (!badLine.empty())
+      return false;
+   return expected.vram == actual.vram && expected.ram == actual.ram;
+}
+
+uint64_t FrameHashLog::remaining()
+{
+   uint64_t count = 0;
+   std::string line;
+   while (mode == VERIFY && std::getline(in, line))
+      if (!line.empty() && line[0] != '#')
+         count++;
+   return count;
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+// Per frame xxHash64 of VRAM (0x2400-0x3fff) and work RAM (0x2000-0x23ff)
+// for golden regression runs.
+//
+// The file is text, one frame per line: "<frame> <vram hash> <ram hash>",
+// hashes in hex. RECORD writes it; VERIFY reads one and compares every
+// frame as it completes, so a long run costs two hashes per frame instead of
+// storing or diffing images.
+class FrameHashLog
+{
+public:
+   enum Mode { RECORD, VERIFY };
+
+   struct Hashes
+   {
+      uint64_t vram;
+      uint64_t ram;
+   };
+
+   FrameHashLog(const char* file, Mode mode);
+
+   static Hashes hash(const uint8_t* memory);
+
+   // Call with the 64K address space at the end of each frame. In VERIFY
+   // mode returns false at the first frame whose hashes differ from the
+   // golden list, that the list does not have, or whose golden line is
+   // damaged or for another frame.
+   bool frame(const uint8_t* memory);
+
+   uint64_t getFrames() { return frames; }
+   const Hashes& getExpected() { return expected; }
+   const Hashes& getActual() { return actual; }
+   bool pastEnd() { return ended; } // The mismatch is a frame beyond the golden list
+   const std::string& getBadLine() { return badLine; } // "line 12 is frame 40" when the golden line was the problem
+
+   // VERIFY: golden frames the run never reached. Reads the rest of the
+   // file, so call it once the run is over.
+   uint64_t remaining();
+
+private:
+   Mode mode;
+   std::ofstream out;
+   std::ifstream in;
+   uint64_t frames = 0;
+   Hashes expected = {};
+   Hashes actual = {};
+   bool ended = false;
+   uint64_t lineNumber = 0;
+   std::string badLine;
+};
@@ -0,0 +1,82 @@
+#include "FrameStream.h"
+
+FrameStreamWriter::FrameStreamWriter(const char* file, uint32_t keyframeInterval)
+   : stream(file, std::ios::binary), index(std::string(file) + ".idx", std::ios::binary), keyframeInterval(keyframeInterval ? keyframeInterval : 1)
+{
+   FrameStreamHeader header = {};
+   std::memcpy(header.magic, FRAME_MAGIC, sizeof(header.magic));
+   header.version = FRAME_VERSION;
+   header.frameSize = FRAME_SIZE;
+   header.keyframeInterval = this->keyframeInterval;
+   stream.write((char*)&header, sizeof(header));
+   offset = sizeof(header);
+
+   FrameIndexHeader indexHeader = {};
+   std::memcpy(indexHeader.magic, FRAME_INDEX_MAGIC, sizeof(indexHeader.magic));
+   indexHeader.version = FRAME_VERSION;
+   index.write((char*)&indexHeader, sizeof(indexHeader));
+}
+
+static void writeVarint(std::vector<uint8_t>& out, uint64_t value)
+{
+   while (value >= 0x80)
+   {
+      out.push_back((uint8_t)(value | 0x80));
+      value >>= 7;
+   }
+   out.push_back((uint8_t)value);
+}
+
+void FrameStreamWriter::append(const uint8_t* memory)
+{
+   if (frames % keyframeInterval == 0)
+   {
+      previous.assign(memory, memory + FRAME_SIZE);
+      writeFrame(FRAME_KEY, previous);
+      return;
+   }
+
+   // XOR against the previous frame and code runs of unchanged (zero) bytes
+   payload.clear();
+   size_t pos = 0;
+   while (pos < FRAME_SIZE)
+   {
+      size_t zeros = 0;
+      while (pos + zeros < FRAME_SIZE && memory[pos + zeros] == previous[pos + zeros])
+         zeros++;
+      size_t start = pos + zeros;
+      size_t end = start;
+      while (end < FRAME_SIZE && memory[end] != previous[end])
+         end++;
+
+      writeVarint(payload, zeros);
+      writeVarint(payload, end - start);
+      for (size_t n = start; n < end; n++)
+         payload.push_back(memory[n] ^ previous[n]);
+      pos = end;
+   }
+
+   std::memcpy(previous.data(), memory, FRAME_SIZE);
+   if (payload.size() >= FRAME_SIZE) // Delta is no smaller than a keyframe, store one instead
+      writeFrame(FRAME_KEY, previous);
+   else
+      writeFrame(FRAME_DELTA, payload);
+}
+
+void FrameStreamWriter::writeFrame(FrameType type, const std::vector<uint8_t>& payload)
+{
+   if (type == FRAME_KEY)
+      keyframe = frames;
+
+   FrameIndexEntry entry = { offset, keyframe, (uint32_t)payload.size() };
+   index.write((char*)&entry, sizeof(entry));
+
+   uint8_t code = type;
+   uint32_t size = (uint32_t)payload.size();
+   stream.write((char*)&code, sizeof(code));
+   stream.write((char*)&size, sizeof(size));
+   stream.write((char*)payload.data(), size);
+
+   offset += sizeof(code) + sizeof(size) + size;
+   frames++;
+}
@@ -0,0 +1,189 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Append-only stream of memory dumps, one per video interrupt.
+//
+// <file>      FrameStreamHeader, then per frame:
+//                uint8_t type; uint32_t size; size bytes of payload
+//             FRAME_KEY payload is the raw dump. FRAME_DELTA payload is the
+//             XOR against the previous frame, run length coded as repeated
+//                varint zeroRun; varint literalCount; literalCount bytes
+//             until the frame is covered.
+// <file>.idx  FrameIndexHeader, then one FrameIndexEntry per frame so any
+//             frame can be reached by seeking to its keyframe.
+//
+// Each frame is byte for byte what Memory::memDump would have written.
+
+const char FRAME_MAGIC[8] = { '8', '0', '8', '0', 'F', 'R', 'M', '\0' };
+const char FRAME_INDEX_MAGIC[8] = { '8', '0', '8', '0', 'F', 'I', 'X', '\0' };
+const uint32_t FRAME_VERSION = 1;
+const uint32_t FRAME_SIZE = 0x3fff; // Same range as Memory::memDump
+
+enum FrameType : uint8_t
+{
+   FRAME_KEY = 0,
+   FRAME_DELTA = 1,
+};
+
+struct FrameStreamHeader
+{
+   char magic[8];
+   uint32_t version;
+   uint32_t frameSize;
+   uint32_t keyframeInterval;
+   uint32_t reserved;
+};
+
+struct FrameIndexHeader
+{
+   char magic[8];
+   uint32_t version;
+   uint32_t reserved;
+};
+
+struct FrameIndexEntry
+{
+   uint64_t offset;   // Of the frame record in the stream
+   uint32_t keyframe; // Frame number of the keyframe this frame depends on
+   uint32_t size;     // Payload size
+};
+
+class FrameStreamWriter
+{
+public:
+   FrameStreamWriter(const char* file, uint32_t keyframeInterval = 120);
+
+   void append(const uint8_t* memory); // FRAME_SIZE bytes
+
+   uint32_t getFrames() { return frames; }
+   uint64_t getBytesWritten() { return offset; }
+
+private:
+   void writeFrame(FrameType type, const std::vector<uint8_t>& payload);
+
+   std::ofstream stream;
+   std::ofstream index;
+   uint32_t keyframeInterval;
+   uint32_t frames = 0;
+   uint32_t keyframe = 0;
+   uint64_t offset = 0;
+
+   std::vector<uint8_t> previous; // Last frame appended
+   std::vector<uint8_t> payload;  // Scratch for encoding
+};
+
+class FrameStreamReader
+{
+public:
+   FrameStreamReader(const char* file) : stream(file, std::ios::binary)
+   {
+      std::ifstream indexStream(std::string(file) + ".idx", std::ios::binary);
+      FrameStreamHeader header;
+      FrameIndexHeader indexHeader;
+      if (!stream.read((char*)&header, sizeof(header))
+         || std::memcmp(header.magic, FRAME_MAGIC, sizeof(header.magic)) != 0
+         || header.version != FRAME_VERSION
+         || !indexStream.read((char*)&indexHeader, sizeof(indexHeader))
+         || std::memcmp(indexHeader.magic, FRAME_INDEX_MAGIC, sizeof(indexHeader.magic)) != 0)
+         throw std::string("Not a frame stream: ") + file;
+
+      frameSize = header.frameSize;
+      FrameIndexEntry entry;
+      while (indexStream.read((char*)&entry, sizeof(entry)))
+         entries.push_back(entry);
+   }
+
+   uint32_t frameCount() { return (uint32_t)entries.size(); }
+   uint32_t getFrameSize() { return frameSize; }
+
+   // Reconstructs frame number `frame`. Sequential reads only apply one delta
+   // each; anything else restarts from the frame's keyframe.
+   bool read(uint32_t frame, std::vector<uint8_t>& out)
+   {
+      if (frame >= entries.size())
+         return false;
+
+      uint32_t start = entries[frame].keyframe;
+      if (haveCurrent && current == frame)
+         start = frame + 1; // Already there
+      else if (haveCurrent && current < frame && current >= start)
+         start = current + 1;
+      else
+         haveCurrent = false;
+
+      for (uint32_t n = start; n <= frame; n++)
+         if (!apply(n))
+         {
+            haveCurrent = false;
+            return false;
+         }
+
+      out = image;
+      return true;
+   }
+
+private:
+   bool apply(uint32_t frame)
+   {
+      const FrameIndexEntry& entry = entries[frame];
+      std::vector<uint8_t> payload(entry.size);
+      uint8_t type;
+      uint32_t size;
+      stream.clear();
+      stream.seekg(entry.offset);
+      if (!stream.read((char*)&type, sizeof(type)) || !stream.read((char*)&size, sizeof(size))
+         || size != entry.size || !stream.read((char*)payload.data(), size))
+         return false;
+
+      if (type == FRAME_KEY)
+      {
+         if (size != frameSize)
+            return false;
+         image = payload;
+      }
+      else
+      {
+         if (!haveCurrent || image.size() != frameSize)
+            return false; // Delta without its base
+         size_t in = 0, pos = 0;
+         while (pos < frameSize)
+         {
+            uint64_t zeros, literals;
+            if (!readVarint(payload, in, zeros) || !readVarint(payload, in, literals)
+               || pos + zeros + literals > frameSize || in + literals > payload.size())
+               return false;
+            pos += (size_t)zeros;
+            for (uint64_t n = 0; n < literals; n++)
+               image[pos++] ^= payload[in++];
+         }
+      }
+      haveCurrent = true;
+      current = frame;
+      return true;
+   }
+
+   static bool readVarint(const std::vector<uint8_t>& data, size_t& in, uint64_t& value)
+   {
+      value = 0;
+      for (int shift = 0; in < data.size() && shift < 64; shift += 7)
+      {
+         uint8_t byte = data[in++];
+         value |= (uint64_t)(byte & 0x7f) << shift;
+         if (!(byte & 0x80))
+            return true;
+      }
+      return false;
+   }
+
+   std::ifstream stream;
+   std::vector<FrameIndexEntry> entries;
+   uint32_t frameSize;
+
+   std::vector<uint8_t> image; // Last reconstructed frame
+   uint32_t current = 0;
+   bool haveCurrent = false;
+};
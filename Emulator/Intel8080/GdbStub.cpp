@@ -0,0 +1,565 @@
+#include "GdbStub.h"
+#include "Breakpoints.h"
+#include "State8080.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#pragma comment(lib, "ws2_32.lib")
+typedef SOCKET Socket;
+#define closeSocket closesocket
+#else
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+typedef int Socket;
+#define INVALID_SOCKET (-1)
+#define closeSocket ::close
+#endif
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0 // A client that went away is noticed on the next read
+#endif
+
+namespace
+{
+   const char HEX[] = "0123456789abcdef";
+
+   void appendByte(std::string& out, uint8_t value)
+   {
+      out += HEX[value >> 4];
+      out += HEX[value & 15];
+   }
+
+   int hexDigit(char digit)
+   {
+      if (digit >= '0' && digit <= '9') return digit - '0';
+      if (digit >= 'a' && digit <= 'f') return digit - 'a' + 10;
+      if (digit >= 'A' && digit <= 'F') return digit - 'A' + 10;
+      return -1;
+   }
+
+   // Four hex digits of a register, low byte first
+   uint16_t littleEndian(const char* text)
+   {
+      return (uint16_t)(hexDigit(text[0]) << 4 | hexDigit(text[1]) | hexDigit(text[2]) << 12 | hexDigit(text[3]) << 8);
+   }
+
+   // Hex number at `text`, moving past it
+   uint32_t parseHex(const char*& text)
+   {
+      uint32_t value = 0;
+      for (int digit; (digit = hexDigit(*text)) >= 0; text++)
+         value = value << 4 | digit;
+      return value;
+   }
+
+   bool readable(Socket socket)
+   {
+      fd_set set;
+      FD_ZERO(&set);
+      FD_SET(socket, &set);
+      timeval now = { 0, 0 };
+      return select((int)socket + 1, &set, nullptr, nullptr, &now) > 0;
+   }
+}
+
+GdbStub::GdbStub(State8080* state, Breakpoints* breakpoints, const std::string& endpoint)
+   : state(state), breakpoints(breakpoints), endpoint(endpoint)
+{
+#ifdef _WIN32
+   WSADATA data;
+   WSAStartup(MAKEWORD(2, 2), &data);
+#endif
+   bool port = !endpoint.empty() && endpoint.find_first_not_of("0123456789") == std::string::npos;
+   Socket socket = INVALID_SOCKET;
+   if (port)
+   {
+      socket = ::socket(AF_INET, SOCK_STREAM, 0);
+      int reuse = 1;
+      setsockopt(socket, SOL_SOCKET, SO_REUSEADDR, (const char*)&reuse, sizeof(reuse));
+      sockaddr_in address = {};
+      address.sin_family = AF_INET;
+      address.sin_port = htons((uint16_t)std::atoi(endpoint.c_str()));
+      address.sin_addr.s_addr = htonl(INADDR_LOOPBACK); // Local clients only
+      if (socket != INVALID_SOCKET && (bind(socket, (sockaddr*)&address, sizeof(address)) != 0 || listen(socket, 1) != 0))
+      {
+         closeSocket(socket);
+         socket = INVALID_SOCKET;
+      }
+   }
+   else
+   {
+#ifdef _WIN32
+      throw std::string("gdb: only TCP ports here, not ") + endpoint;
+#else
+      sockaddr_un address = {};
+      address.sun_family = AF_UNIX;
+      if (endpoint.size() >= sizeof(address.sun_path))
+         throw std::string("gdb: socket path too long: ") + endpoint;
+      std::strcpy(address.sun_path, endpoint.c_str());
+      ::unlink(endpoint.c_str()); // Left over from an earlier run
+      socket = ::socket(AF_UNIX, SOCK_STREAM, 0);
+      if (socket != INVALID_SOCKET && (bind(socket, (sockaddr*)&address, sizeof(address)) != 0 || listen(socket, 1) != 0))
+      {
+         closeSocket(socket);
+         socket = INVALID_SOCKET;
+      }
+#endif
+   }
+   if (socket == INVALID_SOCKET)
+      throw std::string("gdb: can't listen on ") + endpoint;
+
+   // poll() must not block while the game runs
+#ifdef _WIN32
+   u_long nonBlocking = 1;
+   ioctlsocket(socket, FIONBIO, &nonBlocking);
+#else
+   fcntl(socket, F_SETFL, fcntl(socket, F_GETFL) | O_NONBLOCK);
+#endif
+   listener = (intptr_t)socket;
+   std::fprintf(stderr, "gdb: listening on %s\n", endpoint.c_str());
+}
+
+GdbStub::~GdbStub()
+{
+   disconnect();
+   closeSocket((Socket)listener);
+#ifdef _WIN32
+   WSACleanup();
+#else
+   if (endpoint.find_first_not_of("0123456789") != std::string::npos)
+      ::unlink(endpoint.c_str());
+#endif
+}
+
+bool GdbStub::waitForClient()
+{
+   std::fprintf(stderr, "gdb: waiting for a client\n");
+   while (!accept())
+   {
+      fd_set set;
+      FD_ZERO(&set);
+      FD_SET((Socket)listener, &set);
+      select((int)listener + 1, &set, nullptr, nullptr, nullptr);
+   }
+   return serve(SIGNAL_TRAP);
+}
+
+bool GdbStub::accept()
+{
+   Socket socket = ::accept((Socket)listener, nullptr, nullptr);
+   if (socket == INVALID_SOCKET)
+      return false;
+#ifdef _WIN32
+   u_long blocking = 0;
+   ioctlsocket(socket, FIONBIO, &blocking);
+#else
+   fcntl(socket, F_SETFL, fcntl(socket, F_GETFL) & ~O_NONBLOCK); // Not inherited everywhere
+#endif
+   int noDelay = 1; // Replies are small and the client waits for each one
+   setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, (const char*)&noDelay, sizeof(noDelay));
+   client = (intptr_t)socket;
+   noAck = false;
+   buffered = used = 0;
+   std::fprintf(stderr, "gdb: client connected\n");
+   return true;
+}
+
+void GdbStub::disconnect()
+{
+   if (client == -1)
+      return;
+   closeSocket((Socket)client);
+   client = -1;
+   breakpoints->clear(true); // The client's own
+   stepping = false;
+   std::fprintf(stderr, "gdb: client disconnected\n");
+}
+
+bool GdbStub::poll()
+{
+   if (++polls % POLL_EVERY)
+      return true;
+   if (client == -1)
+   {
+      if (!accept())
+         return true;
+      return serve(SIGNAL_TRAP); // A new client expects a stopped target
+   }
+   while (used < buffered || readable((Socket)client))
+   {
+      int byte = readByte();
+      if (byte < 0)
+         return true; // Gone: keep running
+      if (byte == 0x03)
+         return stop(SIGNAL_INT); // Ctrl-C
+   }
+   return true;
+}
+
+int GdbStub::readByte()
+{
+   if (used == buffered)
+   {
+      int received = recv((Socket)client, (char*)buffer, sizeof(buffer), 0);
+      if (received <= 0)
+      {
+         disconnect();
+         return -1;
+      }
+      buffered = received;
+      used = 0;
+   }
+   return buffer[used++];
+}
+
+// "$<payload>#<checksum>", acknowledged with + or -. A lone 0x03 comes
+// back as a one byte packet.
+bool GdbStub::readPacket(std::string& packet)
+{
+   for (;;)
+   {
+      int byte = readByte();
+      if (byte < 0)
+         return false;
+      if (byte == 0x03)
+      {
+         packet = "\x03";
+         return true;
+      }
+      if (byte != '$')
+         continue; // Acks and noise between packets
+
+      packet.clear();
+      uint8_t sum = 0;
+      while ((byte = readByte()) >= 0 && byte != '#')
+      {
+         sum += (uint8_t)byte;
+         if (byte == '}') // Escaped byte
+         {
+            if ((byte = readByte()) < 0)
+               return false;
+            sum += (uint8_t)byte;
+            byte ^= 0x20;
+         }
+         packet += (char)byte;
+      }
+      int high = readByte(), low = readByte();
+      if (byte < 0 || high < 0 || low < 0)
+         return false;
+      if (noAck)
+         return true;
+      bool good = hexDigit((char)high) << 4 == (sum & 0xf0) && hexDigit((char)low) == (sum & 15);
+      send((Socket)client, good ? "+" : "-", 1, MSG_NOSIGNAL);
+      if (good)
+         return true;
+   }
+}
+
+void GdbStub::sendPacket(const std::string& payload)
+{
+   std::string packet = "$";
+   uint8_t sum = 0;
+   for (char c : payload)
+   {
+      if (c == '$' || c == '#' || c == '}' || c == '*')
+      {
+         packet += '}';
+         sum += '}';
+         c ^= 0x20;
+      }
+      packet += c;
+      sum += (uint8_t)c;
+   }
+   packet += '#';
+   appendByte(packet, sum);
+
+   for (int attempt = 0; attempt < 3 && client != -1; attempt++)
+   {
+      send((Socket)client, packet.data(), (int)packet.size(), MSG_NOSIGNAL);
+      if (noAck)
+         return;
+      int ack;
+      while ((ack = readByte()) >= 0 && ack != '+' && ack != '-')
+         ;
+      if (ack != '-')
+         return;
+   }
+}
+
+bool GdbStub::stop(int signal, int32_t watchAddress)
+{
+   std::string reply = watchAddress >= 0 ? "T" : "S";
+   appendByte(reply, (uint8_t)signal);
+   if (watchAddress >= 0)
+   {
+      reply += "watch:";
+      appendByte(reply, (uint8_t)(watchAddress >> 8));
+      appendByte(reply, (uint8_t)watchAddress);
+      reply += ';';
+   }
+   sendPacket(reply);
+   return serve(signal);
+}
+
+bool GdbStub::serve(int signal)
+{
+   lastSignal = signal;
+   stepping = false;
+   resume = NONE;
+   std::string packet, reply;
+   while (resume == NONE)
+   {
+      if (!readPacket(packet))
+      {
+         resume = DETACH; // Client went away: carry on without it
+         break;
+      }
+      reply = handle(packet);
+      if (resume == NONE || resume == DETACH)
+         sendPacket(reply);
+      if (packet == "QStartNoAckMode")
+         noAck = true; // After its own reply, which is still acknowledged
+   }
+
+   if (resume == KILL || resume == DETACH)
+      disconnect();
+   stepping = resume == STEP;
+   return resume != KILL;
+}
+
+uint16_t GdbStub::getRegister(int number)
+{
+   auto& reg = state->Reg;
+   switch (number)
+   {
+   case 0: return reg.a << 8 | reg.f.s << 7 | reg.f.z << 6 | reg.f.a << 4 | reg.f.p << 2 | 1 << 1 | reg.f.c;
+   case 1: return reg.b << 8 | reg.c;
+   case 2: return reg.d << 8 | reg.e;
+   case 3: return reg.h << 8 | reg.l;
+   case 4: return reg.sp;
+   default: return reg.pc;
+   }
+}
+
+void GdbStub::writeRegister(int number, uint16_t value)
+{
+   auto& reg = state->Reg;
+   switch (number)
+   {
+   case 0:
+      reg.a = value >> 8;
+      reg.f.s = value >> 7 & 1;
+      reg.f.z = value >> 6 & 1;
+      reg.f.a = value >> 4 & 1;
+      reg.f.p = value >> 2 & 1;
+      reg.f.c = value & 1;
+      break;
+   case 1: reg.b = value >> 8; reg.c = value & 0xff; break;
+   case 2: reg.d = value >> 8; reg.e = value & 0xff; break;
+   case 3: reg.h = value >> 8; reg.l = value & 0xff; break;
+   case 4: reg.sp = value; break;
+   default: reg.pc = value; break;
+   }
+}
+
+std::string GdbStub::readRegisters()
+{
+   std::string out;
+   for (int number = 0; number < 6; number++)
+   {
+      uint16_t value = getRegister(number);
+      appendByte(out, value & 0xff); // Little endian
+      appendByte(out, value >> 8);
+   }
+   return out;
+}
+
+std::string GdbStub::handle(const std::string& packet)
+{
+   const char* args = packet.c_str() + 1;
+   uint8_t* memory = state->memory->memory;
+   std::string reply;
+
+   switch (packet[0])
+   {
+   case '\x03': // Ctrl-C while already stopped
+   case '?':
+      reply = "S";
+      appendByte(reply, (uint8_t)lastSignal);
+      return reply;
+
+   case 'g':
+      return readRegisters();
+
+   case 'G':
+      for (int number = 0; number < 6 && std::strlen(args) >= 4; number++, args += 4)
+         writeRegister(number, littleEndian(args));
+      return "OK";
+
+   case 'p': // p<n>: AF BC DE HL SP PC, then the z80 registers we don't have
+   {
+      uint32_t number = parseHex(args);
+      if (number >= 6)
+         return "xxxx";
+      uint16_t value = getRegister(number);
+      appendByte(reply, value & 0xff);
+      appendByte(reply, value >> 8);
+      return reply;
+   }
+
+   case 'P': // P<n>=<value, little endian>
+   {
+      uint32_t number = parseHex(args);
+      if (*args++ != '=' || std::strlen(args) < 4)
+         return "E01";
+      if (number < 6)
+         writeRegister(number, littleEndian(args));
+      return "OK";
+   }
+
+   case 'm': // m<address>,<length>
+   {
+      uint32_t address = parseHex(args);
+      if (*args++ != ',')
+         return "E01";
+      uint32_t length = parseHex(args);
+      for (uint32_t n = 0; n < length && n < 0x10000; n++)
+         appendByte(reply, memory[(uint16_t)(address + n)]);
+      return reply;
+   }
+
+   case 'M': // M<address>,<length>:<bytes>
+   {
+      uint32_t address = parseHex(args);
+      if (*args++ != ',')
+         return "E01";
+      uint32_t length = parseHex(args);
+      if (*args++ != ':' || std::strlen(args) < length * 2)
+         return "E01";
+      for (uint32_t n = 0; n < length; n++, args += 2)
+         memory[(uint16_t)(address + n)] = (uint8_t)(hexDigit(args[0]) << 4 | hexDigit(args[1]));
+      return "OK";
+   }
+
+   case 'c': // c[address]
+   case 's':
+      if (*args)
+         state->Reg.pc = (uint16_t)parseHex(args);
+      resume = packet[0] == 's' ? STEP : CONTINUE;
+      return "";
+
+   case 'Z': // Z<type>,<address>,<kind>: 0 and 1 are breakpoints, the same thing here, 2 a write watchpoint
+   case 'z':
+   {
+      if (args[0] < '0' || args[0] > '2')
+         return ""; // Read and access watchpoints: not supported
+      bool watch = args[0] == '2';
+      args += 2;
+      uint16_t address = (uint16_t)parseHex(args);
+      breakpoints->removePlain(watch, address); // gdb may insert the same one twice
+      if (packet[0] == 'Z' && watch)
+         breakpoints->addWatch(address, "", true);
+      else if (packet[0] == 'Z')
+         breakpoints->addAt(address, "", true);
+      return "OK";
+   }
+
+   case 'D':
+      resume = DETACH;
+      return "OK";
+
+   case 'k':
+      resume = KILL;
+      return "";
+
+   case 'H': // Thread selection: there is one
+   case 'T':
+      return "OK";
+
+   case 'q':
+      if (packet.compare(0, 11, "qSupported:") == 0 || packet == "qSupported")
+         return "PacketSize=1000;QStartNoAckMode+";
+      if (packet == "qAttached")
+         return "1";
+      if (packet == "qC")
+         return "QC1";
+      if (packet == "qfThreadInfo")
+         return "m1";
+      if (packet == "qsThreadInfo")
+         return "l";
+      if (packet == "qOffsets")
+         return "Text=0;Data=0;Bss=0";
+      if (packet.compare(0, 6, "qRcmd,") == 0) // monitor <command>, hex encoded
+      {
+         std::string command;
+         for (args = packet.c_str() + 6; hexDigit(args[0]) >= 0 && hexDigit(args[1]) >= 0; args += 2)
+            command += (char)(hexDigit(args[0]) << 4 | hexDigit(args[1]));
+         std::string output = monitor(command);
+         reply = "O";
+         for (char c : output)
+            appendByte(reply, (uint8_t)c);
+         if (!output.empty())
+            sendPacket(reply);
+         return "OK";
+      }
+      return "";
+
+   case 'Q':
+      return packet == "QStartNoAckMode" ? "OK" : "";
+
+   default:
+      return ""; // Not supported
+   }
+}
+
+// monitor break <condition>, watch <address> [condition], delete [n], info
+std::string GdbStub::monitor(const std::string& command)
+{
+   std::istringstream stream(command);
+   std::string verb, rest;
+   stream >> verb;
+   std::getline(stream >> std::ws, rest);
+   std::ostringstream out;
+   try
+   {
+      if (verb == "break" && !rest.empty())
+      {
+         int number = breakpoints->add(rest, true);
+         out << "Breakpoint " << number << std::endl;
+      }
+      else if (verb == "watch" && !rest.empty())
+      {
+         int number = breakpoints->addWatch(rest, true);
+         out << "Watch " << number << std::endl;
+      }
+      else if (verb == "delete" && rest.empty())
+         breakpoints->clear(false);
+      else if (verb == "delete")
+         out << (breakpoints->remove(std::atoi(rest.c_str())) ? "" : "No such breakpoint\n");
+      else if (verb == "info")
+         breakpoints->list(out);
+      else
+         out << "monitor break <condition>      stop where the condition holds; it needs PC==<address>" << std::endl
+             << "monitor watch <hex address or symbol> [condition]  stop after a write there, if the condition holds" << std::endl
+             << "monitor delete [number]        remove one, or all" << std::endl
+             << "monitor info                   list them with their hit counts" << std::endl
+             << "Conditions: PC==0x08F3 && HL>=0x2400 && mem[0x20F8]==0, or with symbols" << std::endl
+             << "PC==PrintMessage && mem[isrDelay]==0, see Common/Condition.h" << std::endl;
+   }
+   catch (const std::string& error)
+   {
+      out << error << std::endl;
+   }
+   return out.str();
+}
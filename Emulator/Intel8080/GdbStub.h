@@ -0,0 +1,83 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+class Breakpoints;
+class State8080;
+
+// GDB remote serial protocol server, so gdb (set architecture z80) or any
+// other RSP client can stop the emulator, look at and change registers and
+// memory, set breakpoints and write watchpoints, step and continue.
+//
+// Registers are sent as gdb's z80 target lays them out: AF BC DE HL SP PC,
+// 16 bits each, little endian. Memory reads and writes go straight to the
+// 64K array: no trace records, and the ROM can be patched.
+//
+// Breakpoints live in Breakpoints, shared with the command line ones; the
+// client's are removed when it goes. Conditional ones come from monitor
+// commands ("monitor help"), so the condition is evaluated here at the
+// anchor address instead of gdb stopping to evaluate it every time.
+class GdbStub
+{
+public:
+   enum Signal { SIGNAL_INT = 2, SIGNAL_TRAP = 5 };
+
+   // endpoint: a TCP port, listened on at 127.0.0.1, or a Unix socket path
+   GdbStub(State8080* state, Breakpoints* breakpoints, const std::string& endpoint);
+   ~GdbStub();
+   GdbStub(const GdbStub&) = delete;
+   GdbStub& operator=(const GdbStub&) = delete;
+
+   // Blocks until a client connects, then serves it as stopped. False if
+   // the client killed the program. The client asks why with '?': RSP only
+   // allows a stop reply in answer to a request.
+   bool waitForClient();
+
+   bool isConnected() { return client != -1; }
+   // The client wants to stop before the next instruction. Only changes in
+   // stop() and poll().
+   bool isStepping() { return stepping; }
+
+   // Once a frame while running: serves a new client as stopped, like
+   // waitForClient, and stops on Ctrl-C. Only every POLL_EVERY calls looks
+   // at the sockets, a system call being worth more than thousands of
+   // instructions. False if the client killed the program.
+   bool poll();
+
+   // Tells the client we stopped, at a watch if watchAddress is not -1, and serves
+   // its requests until it continues, steps or detaches. After it returns
+   // the instruction at PC runs, so resuming at a breakpoint doesn't stop
+   // there again. False if the client killed the program.
+   bool stop(int signal, int32_t watchAddress = -1);
+
+private:
+   bool accept();
+   bool serve(int signal); // Stopped with `signal`: requests until the client resumes, see stop()
+   void disconnect();
+   int readByte();                 // -1 when the client is gone
+   bool readPacket(std::string& packet);
+   void sendPacket(const std::string& payload);
+
+   // Reply to one packet, or empty when it resumes: see `resume`
+   std::string handle(const std::string& packet);
+   std::string monitor(const std::string& command); // Its output
+   std::string readRegisters();
+   void writeRegister(int number, uint16_t value);
+   uint16_t getRegister(int number);
+
+   enum Resume { NONE, CONTINUE, STEP, DETACH, KILL };
+   static const unsigned POLL_EVERY = 16;
+
+   State8080* state;
+   Breakpoints* breakpoints;
+   std::string endpoint;
+   intptr_t listener = -1;
+   intptr_t client = -1;
+   bool stepping = false;
+   bool noAck = false;
+   Resume resume = NONE;
+   int lastSignal = SIGNAL_TRAP;
+   unsigned polls = 0;
+   uint8_t buffer[4096];
+   int buffered = 0, used = 0;
+};
@@ -4,43 +4,79 @@
 #include <iostream>
 #include <iomanip>
 
+#include "Trace.h"
+#include "../Common/Coverage.h"
+#include "../Common/Instrumentation.h"
+
 #define MAX(A,B) ((A)>(B)?(A):(B))
 
 class Memory
 {
 private:
    uint16_t largestAddress;
-   bool enablePrint;
+   uint16_t romEnd; // Writes below this address are refused
+   uint32_t imageSize; // Bytes loaded from the file
+   TraceWriter* trace = nullptr;
+   Instrumentation* instrumentation = nullptr; // The CPU's, set by State8080
+   const uint8_t* watched = nullptr; // Nonzero for the addresses Breakpoints watches
 public:
-   uint8_t memory[0xffff]={};
-   Memory(char* file, bool enablePrint = false)
+   uint8_t memory[0x10000]={};
+   // Watched addresses written since Breakpoints last took them. One
+   // instruction writes two bytes at most (PUSH, SHLD, CALL, an interrupt).
+   static const int MAX_WATCHED_WRITES = 4;
+   uint16_t watchedWrites[MAX_WATCHED_WRITES];
+   int watchedWriteCount = 0;
+   Coverage coverage; // Always kept, marking costs less than testing whether to
+
+   // origin: where the image is loaded (0 for Space Invaders, 0x100 for CP/M programs)
+   // romEnd: first writable address (0x2000 for Space Invaders, 0 for flat RAM)
+   Memory(char* file, uint16_t origin = 0, uint16_t romEnd = 0x2000) : romEnd(romEnd)
    {
-      this->setPrint(enablePrint);
       std::ifstream stream(file, std::ios::binary);
-      stream.read((char*)memory, 0xffff);
+      stream.read((char*)&memory[origin], 0x10000 - origin);
+      imageSize = (uint32_t)stream.gcount();
       stream.close();
       largestAddress = 0;
    }
 
-   void setPrint(bool enablePrint) { this->enablePrint = enablePrint; }
+   void setTrace(TraceWriter* trace) { this->trace = trace; }
+   void setWatched(const uint8_t* watched) { this->watched = watched; }
+   void setInstrumentation(Instrumentation* instrumentation) { this->instrumentation = instrumentation; }
+   uint32_t getImageSize() { return imageSize; }
 
    uint8_t read(uint16_t address)
    {
-      if (enablePrint) std::cout << std::endl << std::hex << std::setw(4) << (int)address << " " << std::setw(2) << (int)memory[address] << " r";
+      if (trace) trace->record(address, memory[address], TRACE_READ);
+      coverage.mark(Coverage::READ, address);
+      instrumentation->memoryRead(address);
+      return memory[address];
+   }
+
+   // An instruction byte: the opcode or its operands. The same read, but
+   // counted as executed instead of read as data.
+   uint8_t fetch(uint16_t address)
+   {
+      if (trace) trace->record(address, memory[address], TRACE_READ);
+      coverage.mark(Coverage::EXECUTED, address);
+      instrumentation->memoryFetch(address);
       return memory[address];
    }
 
    void write(uint16_t address, uint8_t value)
    {
-      if (enablePrint) std::cout << std::endl << std::hex << std::setw(4) << (int)address << " " << std::setw(2) << (int)value << " w";
+      if (trace) trace->record(address, value, TRACE_WRITE);
+      coverage.mark(Coverage::WRITTEN, address);
+      instrumentation->memoryWrite(address);
 
-      if (address < 0x2000)
+      if (address < romEnd)
       {
          std::cerr << "Fatal error" << std::endl;
          return;
       }
 
       memory[address] = value;
+      if (watched && watched[address] && watchedWriteCount < MAX_WATCHED_WRITES)
+         watchedWrites[watchedWriteCount++] = address;
    }
 
    void memDump(const char* file)
@@ -1,11 +1,25 @@
 #include "State8080.h"
 #include "IO.h"
 #include "Memory.h"
+#include "AudioRenderer.h"
+#include "Breakpoints.h"
+#include "CPM.h"
+#include "FrameHash.h"
+#include "FrameStream.h"
+#include "GdbStub.h"
+#include "../Common/Coverage.h"
+#include "../Common/ExecTrace.h"
+#include "../Common/FrameCapture.h"
+#include "../Common/MappedRing.h"
+#include "../Common/Symbols.h"
+#include "../Common/XXHash64.h"
+#include "Trace.h"
 #include <iostream>
 #include <fstream>
 //#include <Windows.h>
 #include <string>
 #include <iomanip>
+#include <vector>
 
 State8080* state;
 
@@ -17,36 +31,157 @@ State8080* state;
 #define JUMP 0xC3
 #define OUT 0xD3
 
-bool print = false;
-bool debug = true;
+char* execTraceFile = nullptr;      // -exec-trace <file>: every instruction into a ring file, see Tools/ExecTraceFormat
+uint64_t execTraceRecords = 1 << 22; // -exec-trace-records <n>: ring size, the last n instructions are kept
+MappedRing* execTrace = nullptr;
+
+char* traceFile = nullptr;   // -trace <file>: binary memory/IO access trace, see Tools/TraceDecode
+bool traceCompress = false;  // -compress: LZ compress trace blocks
+TraceWriter* trace = nullptr;
+
+char* framesFile = nullptr;  // -frames <file>: per interrupt RAM dumps, see Tools/FrameExtract
+int keyframeInterval = 120;  // -keyframe <n>: full dump every n interrupts, deltas in between
+FrameStreamWriter* frames = nullptr;
+
+char* audioFile = nullptr;        // -audio <file>: render the sound board to a .wav
+std::string soundDirectory;       // -sounds <dir>: where the nine sample files live, default the GUI's
+int audioRate = 44100;            // -rate <n>: output sample rate
+char* audioEventsFile = nullptr;  // -audio-events <file>: text log of every sound edge
+AudioRenderer* audio = nullptr;
+
+char* captureFile = nullptr;  // -capture <file or prefix>: record the screen at every frame
+std::string captureFormat;    // -capture-format y4m|raw|png (default from the file extension)
+int captureThreads = 0;       // -capture-threads <n>: encoder threads, default cores - 1
+FrameCapture* capture = nullptr;
+
+char* hashFile = nullptr;       // -hash-record/-hash-verify <file>: per frame VRAM and RAM hashes
+FrameHashLog::Mode hashMode = FrameHashLog::RECORD;
+FrameHashLog* hashes = nullptr;
+bool hashMismatch = false;
+
+char* gdbEndpoint = nullptr; // -gdb <port or socket path>: serve gdb's remote protocol while running
+bool gdbWait = false;        // -gdb-wait: stay stopped at reset until a client connects
+GdbStub* gdb = nullptr;
+
+char* coverageFile = nullptr; // -coverage <file>: save the executed/read/written bitmaps, see Tools/CoverageMerge
+
+char* statsFile = nullptr;    // -stats <file>: counters as JSON lines, or CSV for a .csv name, see Common/Instrumentation.h
+uint64_t statsInterval = 0;   // -stats-interval <n>: also the activity of every n frames, not only the run's total
+std::ofstream* stats = nullptr;
+bool statsCsv = false;
+Counters statsLast = {};      // At the last interval
+uint64_t statsFrames = 0;
+
+char* symbolFile = nullptr; // -symbols <file>: names for conditions, watches and disassembly, default Common/invaders.sym
+Symbols symbols;
+
+std::vector<std::string> breakConditions; // -break <condition>: stop where it holds, see Common/Condition.h
+std::vector<std::string> watchConditions; // -watch "<hex address or symbol> [condition]": stop after a write there
+Breakpoints* breakpoints = nullptr;
+
+uint64_t runSeconds = 2 * 60;   // -seconds <n>: emulated run time
+
+uint64_t cycles = 0; // Emulated clock, also read by the audio renderer
+
+// First frame that differs from the golden hash list: say where, dump the
+// frame's memory next to the list and show the CPU state
+void reportHashMismatch()
+{
+   hashMismatch = true;
+   uint64_t frame = hashes->getFrames() - 1;
+   std::cerr << std::dec << "Hash mismatch at frame " << frame << " (cycle " << cycles << ")";
+   if (hashes->pastEnd())
+      std::cerr << ": golden list has no more frames" << std::endl;
+   else if (!hashes->getBadLine().empty())
+      std::cerr << ": " << hashFile << " " << hashes->getBadLine() << std::endl;
+   else
+   {
+      std::cerr << std::hex << std::setfill('0')
+         << (hashes->getActual().vram != hashes->getExpected().vram ? " VRAM" : "")
+         << (hashes->getActual().ram != hashes->getExpected().ram ? " RAM" : "") << std::endl
+         << "   expected " << std::setw(16) << hashes->getExpected().vram << " " << std::setw(16) << hashes->getExpected().ram << std::endl
+         << "   actual   " << std::setw(16) << hashes->getActual().vram << " " << std::setw(16) << hashes->getActual().ram << std::endl
+         << std::dec;
+   }
+
+   std::string dump = std::string(hashFile) + ".frame" + std::to_string(frame);
+   state->memory->memDump(dump.c_str());
+   std::cerr << "Memory written to " << dump << std::endl;
+   state->displayFull();
+}
+
+void writeStats(const Counters& counters, const std::string& sample)
+{
+   if (statsCsv)
+      Instrumentation::writeCsv(*stats, counters, sample, stats->tellp() == 0);
+   else
+      Instrumentation::writeJson(*stats, counters, sample);
+}
+
+// Every -stats-interval frames: what happened since the last time
+void writeStatsInterval()
+{
+   Counters now = state->getInstrumentation().snapshot();
+   writeStats(now - statsLast, "frames " + std::to_string(statsFrames - statsInterval) + "-" + std::to_string(statsFrames - 1));
+   statsLast = now;
+}
+
+bool isStepping()
+{
+   return gdb && gdb->isStepping();
+}
+
+// A breakpoint or watch hit, or the debugger's step done. A connected
+// client takes over; otherwise say what was hit and wait for one (-gdb) or
+// end the run. False ends the run.
+bool debugStop(const Breakpoints::Entry* hit)
+{
+   if (gdb && gdb->isConnected())
+      return gdb->stop(GdbStub::SIGNAL_TRAP, hit && hit->watch ? hit->address : -1);
+   if (hit)
+      std::cerr << breakpoints->describe(*hit) << " hit at cycle " << std::dec << cycles << std::endl;
+   else
+      std::cerr << "Step done at cycle " << std::dec << cycles << std::endl;
+   state->displayFull();
+   return gdb && gdb->waitForClient();
+}
 
 void CPU_Cycles()
 {
-   long int cycles = 0;
    bool firstInterrupt = true;
    int howOftenToInterrupt = 2'000'000 / 120;
-   int nextInterrupt = 0 + howOftenToInterrupt;
+   uint64_t nextInterrupt = 0 + howOftenToInterrupt;
 
-   std::cout << std::hex << std::setfill('0');
+   if (gdb && gdbWait && !gdb->waitForClient())
+      return;
+   // Kept in locals, so with nothing to stop at the loop tests a register
+   // and with breakpoints armed it costs a couple of loads
+   bool stepping = isStepping();
+   bool debugging = stepping || breakpoints->isArmed();
+   const uint8_t* stopAt = breakpoints->getStops();
+   const int* watchedWrites = &state->memory->watchedWriteCount;
 
-   std::string filePath = "memdump/dump/frame";
-   int frame = 0;
-
-   while (!state->isStopped())
+   while (!state->isHaltedForGood()) // Halted with interrupts on, it idles until the next one
    {
-      if (print) std::cout << std::endl;
-      cycles += state->Emulate8080Op();
-      if (debug)
+      if (debugging && (stopAt[state->Reg.pc] | (*watchedWrites > 0) | stepping))
       {
-         std::cout << " ";
-         state->Disassemble8080Op();
-         state->displayAbrev();
-         std::cout << std::endl;
+         const Breakpoints::Entry* hit = breakpoints->check();
+         if (hit || stepping)
+         {
+            if (!debugStop(hit))
+               break;
+            stepping = isStepping();
+            debugging = stepping || breakpoints->isArmed();
+         }
       }
-
-      if (state->Reg.pc == 0x090e)
+      bool halted = state->isStopped();
+      if (trace) trace->setInstruction(cycles, state->Reg.pc);
+      cycles += state->Emulate8080Op();
+      if (execTrace && !(halted && state->isStopped())) // Idling is not an instruction
       {
-         break;
+         ExecRecord& record = *(ExecRecord*)execTrace->append();
+         state->traceRecord(record);
+         record.cycle = cycles;
       }
 
       //if (state->isInterruptEnabled())
@@ -61,9 +196,26 @@ void CPU_Cycles()
 
       if (cycles >= nextInterrupt)
       {
-         state->memory->memDump((filePath + std::to_string(frame++)).c_str());
+         if (frames) frames->append(state->memory->memory);
+         if (capture && !firstInterrupt) capture->submit(&state->memory->memory[Framebuffer::VRAM]); // End of screen
+         if (!firstInterrupt)
+         {
+            state->getInstrumentation().frame();
+            if (stats && statsInterval && ++statsFrames % statsInterval == 0)
+               writeStatsInterval();
+         }
+         if (hashes && !firstInterrupt && !hashes->frame(state->memory->memory))
+         {
+            reportHashMismatch();
+            break;
+         }
          nextInterrupt += howOftenToInterrupt;
 
+         if (gdb && !gdb->poll()) // New client or Ctrl-C
+            break;
+         stepping = isStepping();
+         debugging = stepping || breakpoints->isArmed();
+
          if (firstInterrupt)
             state->generateInterrupt(0xcf);
          else
@@ -71,7 +223,7 @@ void CPU_Cycles()
 
          firstInterrupt = !firstInterrupt;
       }
-      if (cycles > 2 * 60 * 2'000'000) // Run time
+      if (cycles > runSeconds * 2'000'000) // Run time
          break;
    }
    std::cerr << cycles << std::endl;
@@ -79,17 +231,208 @@ void CPU_Cycles()
 
 void init(char** argv)
 {
-   state = new State8080(new Memory(argv[1], print), print);
+   state = new State8080(new Memory(argv[1]));
+   if (traceFile)
+   {
+      trace = new TraceWriter(traceFile, traceCompress);
+      state->setTrace(trace);
+   }
+   if (framesFile)
+      frames = new FrameStreamWriter(framesFile, keyframeInterval);
+   if (audioFile)
+   {
+      if (soundDirectory.empty())
+         soundDirectory = AudioRenderer::defaultSoundDirectory(argv[0]);
+      audio = new AudioRenderer(audioFile, soundDirectory, audioRate, audioEventsFile);
+      audio->setClock(&cycles);
+      audio->attach(*state->getIO()); // Replaces the silent sound latch on ports 3 and 5
+   }
+   if (hashFile)
+      hashes = new FrameHashLog(hashFile, hashMode);
+   if (symbolFile)
+      symbols.load(symbolFile);
+   else
+      symbols.loadDefault(argv[0], std::cerr);
+   state->setSymbols(&symbols);
+   breakpoints = new Breakpoints(state, &symbols);
+   for (const std::string& condition : breakConditions)
+      breakpoints->add(condition);
+   for (const std::string& watch : watchConditions)
+      breakpoints->addWatch(watch);
+   if (gdbEndpoint)
+      gdb = new GdbStub(state, breakpoints, gdbEndpoint);
+   state->memory->coverage.romHash = XXHash64::hash(state->memory->memory, state->memory->getImageSize());
+   if (statsFile)
+   {
+      std::string name = statsFile;
+      statsCsv = name.size() > 4 && name.compare(name.size() - 4, 4, ".csv") == 0;
+      stats = new std::ofstream(name);
+      if (!*stats)
+         throw std::string("Can't write ") + name;
+   }
+   if (execTraceFile)
+      execTrace = new MappedRing(execTraceFile, sizeof(ExecRecord), execTraceRecords);
+   if (captureFile)
+   {
+      std::string name = captureFile;
+      std::string format = captureFormat;
+      if (format.empty())
+         format = name.size() > 4 && name.compare(name.size() - 4, 4, ".y4m") == 0 ? "y4m"
+            : name.size() > 4 && name.compare(name.size() - 4, 4, ".raw") == 0 ? "raw" : "png";
+      FrameCapture::Format parsed;
+      if (!FrameCapture::parseFormat(format, parsed))
+         throw std::string("Unknown capture format ") + format;
+      capture = new FrameCapture(name, parsed, captureThreads);
+   }
+}
+
+bool parseOptions(int argc, char** argv)
+{
+   for (int arg = 2; arg < argc; arg++)
+   {
+      std::string option = argv[arg];
+      if (option == "-trace" && arg + 1 < argc)
+         traceFile = argv[++arg];
+      else if (option == "-compress")
+         traceCompress = true;
+      else if (option == "-frames" && arg + 1 < argc)
+         framesFile = argv[++arg];
+      else if (option == "-keyframe" && arg + 1 < argc)
+         keyframeInterval = std::stoi(argv[++arg]);
+      else if (option == "-audio" && arg + 1 < argc)
+         audioFile = argv[++arg];
+      else if (option == "-sounds" && arg + 1 < argc)
+         soundDirectory = argv[++arg];
+      else if (option == "-rate" && arg + 1 < argc)
+         audioRate = std::stoi(argv[++arg]);
+      else if (option == "-audio-events" && arg + 1 < argc)
+         audioEventsFile = argv[++arg];
+      else if ((option == "-hash-record" || option == "-hash-verify") && arg + 1 < argc)
+      {
+         hashFile = argv[++arg];
+         hashMode = option == "-hash-record" ? FrameHashLog::RECORD : FrameHashLog::VERIFY;
+      }
+      else if (option == "-exec-trace" && arg + 1 < argc)
+         execTraceFile = argv[++arg];
+      else if (option == "-exec-trace-records" && arg + 1 < argc)
+         execTraceRecords = std::stoull(argv[++arg]);
+      else if (option == "-gdb" && arg + 1 < argc)
+         gdbEndpoint = argv[++arg];
+      else if (option == "-gdb-wait")
+         gdbWait = true;
+      else if (option == "-break" && arg + 1 < argc)
+         breakConditions.push_back(argv[++arg]);
+      else if (option == "-watch" && arg + 1 < argc)
+         watchConditions.push_back(argv[++arg]);
+      else if (option == "-stats" && arg + 1 < argc)
+         statsFile = argv[++arg];
+      else if (option == "-stats-interval" && arg + 1 < argc)
+         statsInterval = std::stoull(argv[++arg]);
+      else if (option == "-coverage" && arg + 1 < argc)
+         coverageFile = argv[++arg];
+      else if (option == "-symbols" && arg + 1 < argc)
+         symbolFile = argv[++arg];
+      else if (option == "-seconds" && arg + 1 < argc)
+         runSeconds = std::stoull(argv[++arg]);
+      else if (option == "-capture" && arg + 1 < argc)
+         captureFile = argv[++arg];
+      else if (option == "-capture-format" && arg + 1 < argc)
+         captureFormat = argv[++arg];
+      else if (option == "-capture-threads" && arg + 1 < argc)
+         captureThreads = std::stoi(argv[++arg]);
+      else
+      {
+         std::cerr << "Unknown option " << option << std::endl;
+         return false;
+      }
+   }
+   return true;
+}
+
+// Intel8080 -cpm <program.com>...
+// Runs CP/M test programs one after another and reports pass/fail and speed
+int runCPMTests(int count, char** programs)
+{
+   std::vector<CPMResult> results;
+   for (int n = 0; n < count; n++)
+   {
+      std::cout << "==== " << programs[n] << std::endl;
+      results.push_back(runCPM(programs[n]));
+      std::cout << std::endl;
+   }
+
+   bool allPassed = true;
+   std::cout << std::endl << std::dec << std::setfill(' ');
+   for (const CPMResult& result : results)
+   {
+      std::cout << std::left << std::setw(16) << result.program << std::right
+         << (result.passed ? " PASS " : " FAIL ")
+         << std::setw(14) << result.cycles << " cycles "
+         << std::setw(12) << result.instructions << " instructions "
+         << std::fixed << std::setprecision(3) << std::setw(9) << result.seconds << " s "
+         << std::setprecision(1) << std::setw(8) << (result.seconds > 0 ? result.cycles / result.seconds / 1e6 : 0) << " MHz"
+         << (result.finished ? "" : " (did not reach warm boot)") << std::endl;
+      allPassed = allPassed && result.passed;
+   }
+   return allPassed ? 0 : 1;
 }
 
 int main(int argc, char** argv)
 {
-   if (argc != 2)
+   if (argc >= 3 && std::string(argv[1]) == "-cpm")
+      return runCPMTests(argc - 2, &argv[2]);
+
+   if (argc < 2 || !parseOptions(argc, argv))
       return 0;
 
-   init(argv);
+   try
+   {
+      init(argv);
+   }
+   catch (const std::string& error)
+   {
+      std::cerr << error << std::endl;
+      return 1;
+   }
 
    CPU_Cycles();
 
-   return 0;
+   if (trace)
+   {
+      delete trace; // Flushes remaining records
+      state->setTrace(nullptr);
+   }
+   delete frames;
+   delete execTrace;
+   if (stats)
+   {
+      writeStats(state->getInstrumentation().snapshot(), "total");
+      delete stats;
+   }
+   if (coverageFile && !state->memory->coverage.save(coverageFile))
+      std::cerr << "Can't write " << coverageFile << std::endl;
+   delete gdb;
+   delete breakpoints;
+   delete audio; // Mixes up to the last cycle and closes the .wav
+   if (hashes)
+   {
+      uint64_t missing = hashMode == FrameHashLog::VERIFY && !hashMismatch ? hashes->remaining() : 0;
+      if (missing)
+      {
+         std::cerr << "Run ended after " << std::dec << hashes->getFrames() << " frames, the golden list has "
+            << missing << " more frames" << std::endl;
+         hashMismatch = true;
+      }
+      else if (hashMode == FrameHashLog::VERIFY && !hashMismatch)
+         std::cerr << std::dec << hashes->getFrames() << " frames match " << hashFile << std::endl;
+      delete hashes;
+   }
+   if (capture)
+   {
+      capture->finish();
+      capture->report(std::cerr);
+      delete capture;
+   }
+
+   return hashMismatch ? 1 : 0;
 }
\ No newline at end of file
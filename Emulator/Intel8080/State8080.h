@@ -1,6 +1,8 @@
 #pragma once
 #include "IO.h"
 #include "Memory.h"
+#include "Trace.h"
+#include "../Common/Instrumentation.h"
 #include <cstdint> // uint8_t, uint16_t, uint32_t
 
 #define SET 1
@@ -13,6 +15,9 @@
 
 uint8_t parity(uint8_t v);
 
+struct ExecRecord;
+class Symbols;
+
 class State8080 {
 public:
    struct Reg
@@ -34,18 +39,24 @@ public:
    } Reg;
 
    Memory *memory;
-   State8080(Memory *memory, bool enablePrint = false) : memory(memory), io(new IO()) { setPrint(enablePrint); }
+   State8080(Memory *memory) : memory(memory), io(new IO()) { memory->setInstrumentation(&instrumentation); }
+   ~State8080() { delete io; }
 
-   void setPrint(bool enablePrint) { this->enablePrint = enablePrint; }
+   void setTrace(TraceWriter* trace) { this->trace = trace; memory->setTrace(trace); }
+   IO* getIO() { return io; }
+   Instrumentation& getInstrumentation() { return instrumentation; }
+   void setSymbols(const Symbols* symbols) { this->symbols = symbols; } // Names for Disassemble8080Op
 
    int  Emulate8080Op();
    int  Disassemble8080Op();
    void displayFull();
    void displayAbrev();
+   void traceRecord(ExecRecord& record); // What displayAbrev shows, for the execution trace
    bool isStopped() { return stopped; }
+   bool isHaltedForGood() { return stopped && !interruptEnabled; } // HLT with interrupts off: nothing wakes it
    bool isInterruptEnabled() { return interruptEnabled; }
 
-   uint8_t immediate(uint8_t byte = 1) { return memory->read(Reg.pc + byte); }
+   uint8_t immediate(uint8_t byte = 1) { return memory->fetch(Reg.pc + byte); }
 
    uint16_t address() { return (immediate(1) << 0) | (immediate(2) << 8); }
 
@@ -90,14 +101,18 @@ public:
       }
       return Reg.pc;
    }
-   void report(std::ostream &stream);
 private:
-   bool enablePrint;
+   static const int HALT_CYCLES = 4; // Halted, the CPU looks for an interrupt this often
+
+   int execute(uint8_t opcode); // Emulate8080Op after the fetch
+
+   TraceWriter* trace = nullptr;
+   const Symbols* symbols = nullptr;
+   Instrumentation instrumentation;
    IO *io;
    bool interruptEnabled = false;  // Are we ready to take interrupts?
    bool interruptRequested = false; // Is there an interrupt now?
    unsigned char interruptOpcode = 0;
    bool stopped = false;
-   long int hitCount[256] = {};
    bool updatePC = true;
 };
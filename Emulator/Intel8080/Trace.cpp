@@ -0,0 +1,74 @@
+#include "Trace.h"
+#include "../Common/LZBlock.h"
+
+#include <chrono>
+#include <cstring>
+
+TraceWriter::TraceWriter(const char* file, bool compress) : stream(file, std::ios::binary), compress(compress)
+{
+   TraceHeader header = {};
+   std::memcpy(header.magic, TRACE_MAGIC, sizeof(header.magic));
+   header.version = TRACE_VERSION;
+   header.recordSize = sizeof(TraceRecord);
+   stream.write((char*)&header, sizeof(header));
+
+   writer = std::thread(&TraceWriter::run, this);
+}
+
+TraceWriter::~TraceWriter()
+{
+   stopping = true;
+   writer.join();
+   stream.close();
+}
+
+void TraceWriter::run()
+{
+   std::vector<TraceRecord> block(BLOCK_RECORDS);
+   std::size_t used = 0;
+
+   for (;;)
+   {
+      bool stop = stopping; // Read before draining so nothing pushed earlier is missed
+      std::size_t got = ring.pop(&block[used], BLOCK_RECORDS - used);
+      used += got;
+
+      if (used == BLOCK_RECORDS || (stop && got == 0))
+      {
+         if (used != 0)
+         {
+            block.resize(used);
+            writeBlock(block);
+            block.resize(BLOCK_RECORDS);
+            used = 0;
+         }
+         if (stop && ring.empty())
+            break;
+      }
+      else if (got == 0)
+         std::this_thread::sleep_for(std::chrono::microseconds(500)); // Nothing to do, let the emulator fill the ring
+   }
+}
+
+void TraceWriter::writeBlock(const std::vector<TraceRecord>& block)
+{
+   uint32_t rawSize = (uint32_t)(block.size() * sizeof(TraceRecord));
+   const uint8_t* raw = (const uint8_t*)block.data();
+
+   std::vector<uint8_t> packed;
+   if (compress)
+   {
+      packed.reserve(rawSize / 2);
+      LZBlock::compress(raw, rawSize, packed);
+   }
+
+   bool usePacked = compress && packed.size() < rawSize;
+   uint32_t storedSize = usePacked ? (uint32_t)packed.size() : rawSize;
+
+   stream.write((char*)&rawSize, sizeof(rawSize));
+   stream.write((char*)&storedSize, sizeof(storedSize));
+   stream.write(usePacked ? (char*)packed.data() : (char*)raw, storedSize);
+
+   records += block.size();
+   bytesWritten += sizeof(rawSize) + sizeof(storedSize) + storedSize;
+}
@@ -0,0 +1,140 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../Common/LZBlock.h"
+#include "../Common/SPSCRing.h"
+
+// Binary memory access trace
+//
+// File layout:
+//    TraceHeader
+//    Blocks of { uint32_t rawSize; uint32_t storedSize; storedSize bytes }
+// A block is LZBlock compressed when storedSize != rawSize, otherwise the
+// records are stored as is. rawSize is always a multiple of sizeof(TraceRecord).
+
+enum TraceKind : uint8_t
+{
+   TRACE_READ  = 'r',
+   TRACE_WRITE = 'w',
+   TRACE_IN    = 'I',
+   TRACE_OUT   = 'O',
+};
+
+struct TraceRecord
+{
+   uint64_t cycle;   // Cycle count when the instruction started
+   uint16_t pc;      // Address of the instruction doing the access
+   uint16_t address; // Memory address, or port number for IN/OUT
+   uint8_t value;    // Byte read or written
+   uint8_t kind;     // TraceKind
+   uint8_t reserved[2];
+};
+static_assert(sizeof(TraceRecord) == 16, "TraceRecord must stay 16 bytes");
+
+struct TraceHeader
+{
+   char magic[8];        // "8080MTR\0"
+   uint32_t version;     // TRACE_VERSION
+   uint32_t recordSize;  // sizeof(TraceRecord)
+};
+
+const char TRACE_MAGIC[8] = { '8', '0', '8', '0', 'M', 'T', 'R', '\0' };
+const uint32_t TRACE_VERSION = 1;
+
+class TraceWriter
+{
+public:
+   TraceWriter(const char* file, bool compress = false);
+   ~TraceWriter();
+
+   // Called by the CPU loop before each instruction so that every access
+   // recorded during it carries the same cycle and PC
+   void setInstruction(uint64_t cycle, uint16_t pc)
+   {
+      this->cycle = cycle;
+      this->pc = pc;
+   }
+
+   void record(uint16_t address, uint8_t value, TraceKind kind)
+   {
+      TraceRecord record = { cycle, pc, address, value, kind, {} };
+      while (!ring.push(record)) // Lossless: wait for the writer when it falls behind
+         std::this_thread::yield();
+   }
+
+   uint64_t getRecords() { return records; }
+   uint64_t getBytesWritten() { return bytesWritten; }
+
+private:
+   static const std::size_t RING_SIZE = 1 << 18;       // Records
+   static const std::size_t BLOCK_RECORDS = 1 << 16;   // Records per block on disk (1 MiB)
+
+   void run(); // Writer thread
+   void writeBlock(const std::vector<TraceRecord>& block);
+
+   SPSCRing<TraceRecord, RING_SIZE> ring;
+   std::ofstream stream;
+   std::thread writer;
+   std::atomic<bool> stopping{ false };
+   bool compress;
+
+   uint64_t cycle = 0;
+   uint16_t pc = 0;
+
+   uint64_t records = 0;
+   uint64_t bytesWritten = 0;
+};
+
+// Reads a trace file back a record at a time, a block in memory at once
+class TraceReader
+{
+public:
+   // Throws a std::string if the file is not a memory trace
+   explicit TraceReader(const std::string& path) : stream(path, std::ios::binary)
+   {
+      TraceHeader header;
+      if (!stream.read((char*)&header, sizeof(header))
+         || std::memcmp(header.magic, TRACE_MAGIC, sizeof(header.magic)) != 0
+         || header.version != TRACE_VERSION
+         || header.recordSize != sizeof(TraceRecord))
+         throw path + " is not a memory trace";
+   }
+
+   // False at the end of the file. Throws a std::string for a damaged one.
+   bool next(TraceRecord& record)
+   {
+      while (position == records.size())
+      {
+         uint32_t rawSize, storedSize;
+         if (!stream.read((char*)&rawSize, sizeof(rawSize)) || !stream.read((char*)&storedSize, sizeof(storedSize)))
+            return false;
+         records.resize(rawSize / sizeof(TraceRecord));
+         if (storedSize == rawSize)
+            stream.read((char*)records.data(), rawSize);
+         else
+         {
+            stored.resize(storedSize);
+            stream.read((char*)stored.data(), storedSize);
+            if (stream && !LZBlock::decompress(stored.data(), storedSize, (uint8_t*)records.data(), rawSize))
+               throw std::string("Corrupt block");
+         }
+         if (!stream)
+            throw std::string("Truncated trace");
+         position = 0;
+      }
+      record = records[position++];
+      return true;
+   }
+
+private:
+   std::ifstream stream;
+   std::vector<uint8_t> stored;
+   std::vector<TraceRecord> records;
+   size_t position = 0;
+};
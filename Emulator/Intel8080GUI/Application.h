@@ -1,6 +1,6 @@
 #pragma once
 #include <string>
-#include <vector>
+#include <cstdint>
 
 #include "cleanup.h"
 
@@ -14,7 +14,6 @@ public:
       try
       {
          init();
-         pixels.resize(WIDTH * HEIGHT * 4, 0);
       }
       catch (const std::string& msg)
       {
@@ -27,20 +26,30 @@ public:
       SDL_Quit();
    }
 
-   void update(std::vector<uint8_t> &pixels, int pitch)
+   // The frame is written straight into the streaming texture: lock() hands
+   // out its pixels (ABGR8888, rows `pitch` bytes apart), present() unlocks
+   // and shows them in the same iteration
+   uint32_t* lock(int& pitch)
    {
+      void* pixels;
+      if (SDL_LockTexture(texture, nullptr, &pixels, &pitch) != 0)
+         throw logSDLError("LockTexture");
+      return (uint32_t*)pixels;
+   }
+   void present()
+   {
+      SDL_UnlockTexture(texture);
       SDL_RenderClear(renderer);
       SDL_RenderCopy(renderer, texture, nullptr, nullptr);
       SDL_RenderPresent(renderer);
-      SDL_UpdateTexture(texture, nullptr, &pixels[0], pitch);
    }
+
+   void setTitle(const std::string& title) { SDL_SetWindowTitle(window, title.c_str()); }
 private:
    SDL_Window* window;
    SDL_Renderer* renderer;
    SDL_Texture* texture;
 
-   std::vector<uint8_t> pixels;
-
    void init()
    {
       if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_TIMER | SDL_INIT_AUDIO) != 0)
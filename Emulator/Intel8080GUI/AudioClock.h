@@ -0,0 +1,45 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+#include "stdafx.h"
+
+// Time according to the sound card: output frames SDL_mixer has mixed,
+// counted from its post-mix callback, divided by the device rate. Used as
+// the reference clock for the emulation's FramePacer so emulated time does
+// not slowly drift away from the audio.
+class AudioClock
+{
+public:
+   AudioClock()
+   {
+      Uint16 format;
+      int channels;
+      if (Mix_QuerySpec(&rate, &format, &channels) != 0)
+      {
+         frameBytes = channels * (format & 0xff) / 8; // Low byte of an SDL audio format is the sample size in bits
+         Mix_SetPostMix(&AudioClock::postMix, this);
+      }
+   }
+   ~AudioClock() { Mix_SetPostMix(nullptr, nullptr); }
+
+   bool isRunning() { return frameBytes != 0; }
+
+   // FramePacer::ReferenceClock
+   static double seconds(void* self)
+   {
+      AudioClock* clock = (AudioClock*)self;
+      return (double)clock->frames.load(std::memory_order_relaxed) / clock->rate;
+   }
+
+private:
+   static void postMix(void* self, Uint8*, int bytes)
+   {
+      AudioClock* clock = (AudioClock*)self;
+      clock->frames.fetch_add(bytes / clock->frameBytes, std::memory_order_relaxed);
+   }
+
+   int rate = 0;
+   int frameBytes = 0;
+   std::atomic<uint64_t> frames{ 0 };
+};
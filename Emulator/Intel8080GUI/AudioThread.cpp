@@ -0,0 +1,75 @@
+#include "AudioThread.h"
+
+#include <chrono>
+#include <deque>
+
+AudioThread::AudioThread(WAV* sounds) : sounds(sounds)
+{
+   Mix_ReserveChannels(UFO_CHANNEL + 1); // Keep one shots off the UFO loop's channel
+   thread = std::thread(&AudioThread::run, this);
+}
+
+AudioThread::~AudioThread()
+{
+   stopping = true;
+   thread.join();
+   Mix_HaltChannel(-1);
+}
+
+void AudioThread::run()
+{
+   typedef std::chrono::steady_clock Clock;
+   const std::chrono::microseconds latency(LATENCY_US), resync(RESYNC_US);
+
+   std::deque<SoundEvent> pending; // Single producer, so already in cycle order
+   bool anchored = false;
+   Clock::time_point anchorTime;
+   uint64_t anchorCycle = 0;
+
+   while (!stopping)
+   {
+      SoundEvent event;
+      while (queue.pop(event))
+         pending.push_back(event);
+
+      Clock::time_point now = Clock::now();
+      while (!pending.empty())
+      {
+         const SoundEvent& next = pending.front();
+         if (!anchored)
+         {
+            anchorTime = now + latency;
+            anchorCycle = next.cycle;
+            anchored = true;
+         }
+
+         int64_t cycles = (int64_t)(next.cycle - anchorCycle);
+         Clock::time_point due = anchorTime + std::chrono::microseconds(cycles * 1'000'000 / CLOCK_SPEED);
+         if (due - now > resync || now - due > resync)
+         {
+            anchored = false; // Emulation drifted (paused, fast forward, slow host); start a new schedule here
+            continue;
+         }
+         if (due > now)
+            break; // Not yet
+
+         play(next);
+         pending.pop_front();
+      }
+
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+   }
+}
+
+void AudioThread::play(const SoundEvent& event)
+{
+   if (event.sound == UFO)
+   {
+      if (event.on)
+         Mix_PlayChannel(UFO_CHANNEL, sounds[UFO], -1); // Loop until the bit is cleared
+      else
+         Mix_HaltChannel(UFO_CHANNEL);
+   }
+   else if (event.on)
+      Mix_PlayChannel(-1, sounds[event.sound], 0);
+}
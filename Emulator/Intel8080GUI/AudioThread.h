@@ -0,0 +1,53 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+#include "../Common/SPSCRing.h"
+
+#include "stdafx.h"
+
+// A sound turning on or off at an emulated time
+struct SoundEvent
+{
+   uint64_t cycle; // Emulated cycle of the OUT that changed the bit
+   uint8_t sound;  // 0-3 port 3 bits, 4-8 port 5 bits
+   bool on;        // Rising (true) or falling edge
+};
+
+// Plays sound events on its own thread so the emulation thread never waits
+// on SDL_mixer.
+//
+// Events are scheduled against emulated time: the first event anchors
+// emulated cycle -> host time (plus LATENCY of buffering), and every later
+// event is played at anchor + (cycle - anchorCycle) / CLOCK_SPEED. If the
+// emulator drifts too far from that schedule (paused, fast forwarded, slow
+// host) the anchor is reset instead of playing a burst of late sounds.
+//
+// The UFO (sound 0) loops on a reserved channel from its rising edge to its
+// falling edge; every other sound is a one shot started on its rising edge.
+class AudioThread
+{
+public:
+   static const int UFO = 0;
+   static const int UFO_CHANNEL = 0;
+
+   AudioThread(WAV* sounds);
+   ~AudioThread();
+
+   // Emulation thread only. Returns false (and drops the event) if the
+   // audio thread has fallen a full queue behind.
+   bool post(const SoundEvent& event) { return queue.push(event); }
+
+private:
+   static const int64_t LATENCY_US = 2 * 1'000'000 / SCREEN_FPS; // Two frames of slack for emulation jitter
+   static const int64_t RESYNC_US = 250'000; // Re-anchor when this far off schedule
+
+   void run();
+   void play(const SoundEvent& event);
+
+   WAV* sounds;
+   SPSCRing<SoundEvent, 1024> queue;
+   std::thread thread;
+   std::atomic<bool> stopping{ false };
+};
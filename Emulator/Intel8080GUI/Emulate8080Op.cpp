@@ -3,6 +3,7 @@
 #include <algorithm>
 
 #include "OpcodeFunctions.h"
+#include "../Common/Opcodes.h"
 
 #define FOR_CPUDIAG
 #define DEBUG
@@ -14,12 +15,20 @@ void State8080::generateInterrupt(uint8_t opcode)
 {
    interruptOpcode = opcode;
    interruptRequested = true;
+   instrumentation.interruptRequested();
 }
 
 int State8080::Emulate8080Op()
 {
-   if (stopped) // Halt state
-      return 0;
+   if (stopped) // Halt state: idle until an interrupt
+   {
+      if (!interruptRequested || !interrupt_enabled)
+      {
+         instrumentation.halted(HALT_CYCLES);
+         return HALT_CYCLES;
+      }
+      stopped = false;
+   }
 
    unsigned char opcode;
 
@@ -29,6 +38,7 @@ int State8080::Emulate8080Op()
       interruptRequested = false;
       opcode = interruptOpcode; // Fetch interrupt opcode
       this->updatePC = false;
+      instrumentation.interruptTaken(opcode);
    }
    else
    {
@@ -36,6 +46,14 @@ int State8080::Emulate8080Op()
       this->updatePC = true;
    }
 
+   int cycles = execute(opcode);
+   instrumentation.instruction(opcode, cycles);
+   return cycles;
+}
+
+int State8080::execute(uint8_t opcode)
+{
+   const Opcodes::Info& info = Opcodes::TABLE[opcode]; // Cycle counts
    switch (opcode)
    {          // Opcode Instruction size  flags          function
    // CARRY BIT INSTRUCTIONS: CMC, STC
@@ -43,13 +61,13 @@ int State8080::Emulate8080Op()
    {
       Reg.f.c = !Reg.f.c;
       this->incrementPC(1);
-      return 4; // 4 cycles
+      return info.cycles;
    }
    case 0x37: // 0x37   STC         1     CY             CY <- 1
    {
       Reg.f.c = 1;
       this->incrementPC(1);
-      return 4; // 4 cycles
+      return info.cycles;
    }
 
    // SINGLE REGISTER INSTRUCTIONS: INR, DCR, CMA, DAA
@@ -64,7 +82,7 @@ int State8080::Emulate8080Op()
    {
       INR(this, CODE_1);
       this->incrementPC(1);
-      return 5; // 5 cycles
+      return info.cycles;
    }
 
    case 0x05: // 0x05   DCR B       1     Z S P AC       B <- B-1
@@ -78,27 +96,27 @@ int State8080::Emulate8080Op()
    {
       DCR(this, CODE_1);
       this->incrementPC(1);
-      return 5; // 5 cycles
+      return info.cycles;
    }
 
    case 0x2F: // 0x2f   CMA         1                    A <- !A
    {
       Reg.a = ~Reg.a;
       this->incrementPC(1);
-      return 4; // 4 cycles
+      return info.cycles;
    }
    case 0x27: // 0x27   DAA         1     Z S P CY AC    special
    {
       DAA(this);
       this->incrementPC(1);
-      return 4; // 4 cycles
+      return info.cycles;
    }
 
    // NOP INSTRUCTION
    case 0x00: // 0x00   NOP         1
    {
       this->incrementPC(1);
-      return 4; // 4 cycles
+      return info.cycles;
    }
 
    // DATA TRANSFER INSTRUCTIONS: MOV, STAX, LDAX
@@ -171,33 +189,33 @@ int State8080::Emulate8080Op()
       getRegister(dst) = getRegister(src);
 
       this->incrementPC(1);
-      return (dst == 6) || (src == 6) ? 7 : 5; // 7 cycles if memory operation, else 5 cycles
+      return info.cycles;
    }
 
    case 0x02: // 0x02   STAX B      1                    (BC) <- A
    {
       memory[Reg.b << 8 | Reg.c] = Reg.a;
       this->incrementPC(1);
-      return 7; // 7 cycles
+      return info.cycles;
    }
    case 0x12: // 0x12   STAX D      1                    (DE) <- A
    {
       memory[Reg.d << 8 | Reg.e] = Reg.a;
       this->incrementPC(1);
-      return 7; // 7 cycles
+      return info.cycles;
    }
 
    case 0x0A: // 0x0a   LDAX B      1                    A <- (BC)
    {
       Reg.a = memory[Reg.b << 8 | Reg.c];
       this->incrementPC(1);
-      return 7; // 7 cycles
+      return info.cycles;
    }
    case 0x1A: // 0x1a   LDAX D      1                    A <- (DE)
    {
       Reg.a = memory[Reg.d << 8 | Reg.e];
       this->incrementPC(1);
-      return 7; // 7 cycles
+      return info.cycles;
    }
 
    // REGISTER OR MEMORY TO ACCUMULATOR INSTRUCTIONS: ADD, ADC, SUB, SBB, ANA, XRA, ORA, CMP
@@ -277,7 +295,7 @@ int State8080::Emulate8080Op()
 
       // Update program counter
       this->incrementPC(1);
-      return reg == 6 ? 7 : 4; // 7 cycles if memory access, else 4 cycles
+      return info.cycles;
    }
 
    // ROTATE ACCUMULATOR INSTRUCTIONS: RLC, RRC, RAL, RAR
@@ -290,7 +308,7 @@ int State8080::Emulate8080Op()
       Reg.a = ((Reg.a << 1) & 0xfe) | ((Reg.a >> 7) & 0x01);
 
       this->incrementPC(1);
-      return 4; // 4 cycles
+      return info.cycles;
    }
    case 0x0F: // 0x0f   RRC         1     CY             A = A >> 1; bit 7 = prev bit 0; CY = prev bit 0
    {
@@ -301,7 +319,7 @@ int State8080::Emulate8080Op()
       Reg.a = ((Reg.a >> 1) & 0x7f) | ((Reg.a << 7) & 0x80);
 
       this->incrementPC(1);
-      return 4; // 4 cycles
+      return info.cycles;
    }
    case 0x17: // 0x17   RAL         1     CY             A = A << 1; bit 0 = prev CY; CY = prev bit 7
    {
@@ -317,7 +335,7 @@ int State8080::Emulate8080Op()
       Reg.a = (Reg.a & 0xfe) | (carry << 0);
 
       this->incrementPC(1);
-      return 4; // 4 cycles
+      return info.cycles;
       // * Originally high-order, but I followed low-order to match diagram depicted.
    }
    case 0x1F: // 0x1f   RAR         1     CY             A = A >> 1; bit 7 = prev bit 7; CY = prev bit 0
@@ -334,7 +352,7 @@ int State8080::Emulate8080Op()
       Reg.a = (Reg.a & 0x7f) | (carry << 7);
 
       this->incrementPC(1);
-      return 4; // 4 cycles
+      return info.cycles;
    }
 
    // REGISTER PAIR INSTRUCTIONS: PUSH, POP, DAD INX, DCX, XCHG, XTHL, SPHL
@@ -342,19 +360,19 @@ int State8080::Emulate8080Op()
    {
       PUSH(this, Reg.b, Reg.c);
       this->incrementPC(1);
-      return 11; // 11 cycles
+      return info.cycles;
    }
    case 0xD5: // 0xd5   PUSH D      1                    (sp-2)<-E; (sp-1)<-D; sp <- sp - 2
    {
       PUSH(this, Reg.d, Reg.e);
       this->incrementPC(1);
-      return 11; // 11 cycles
+      return info.cycles;
    }
    case 0xE5: // 0xe5   PUSH H      1                    (sp-2)<-L; (sp-1)<-H; sp <- sp - 2
    {
       PUSH(this, Reg.h, Reg.l);
       this->incrementPC(1);
-      return 11; // 11 cycles
+      return info.cycles;
    }
    case 0xF5: // 0xf5   PUSH PSW    1                    (sp-2)<-flags; (sp-1)<-A; sp <- sp - 2
    {
@@ -368,26 +386,26 @@ int State8080::Emulate8080Op()
          (1 << 1)       |
          (Reg.f.c << 0));
       this->incrementPC(1);
-      return 11; // 11 cycles
+      return info.cycles;
    }
 
    case 0xC1: // 0xc1   POP B       1                    C <- (sp); B <- (sp+1); sp <- sp+2
    {
       POP(this, Reg.b, Reg.c);
       this->incrementPC(1);
-      return 10; // 10 cycles
+      return info.cycles;
    }
    case 0xD1: // 0xd1   POP D       1                    E <- (sp); D <- (sp+1); sp <- sp+2
    {
       POP(this, Reg.d, Reg.e);
       this->incrementPC(1);
-      return 10; // 10 cycles
+      return info.cycles;
    }
    case 0xE1: // 0xe1   POP H       1                    L <- (sp); H <- (sp+1); sp <- sp+2
    {
       POP(this, Reg.h, Reg.l);
       this->incrementPC(1);
-      return 10; // 10 cycles
+      return info.cycles;
    }
    case 0xF1: // 0xf1   POP PSW     1     Z S P CY AC    flags <- (sp); A <- (sp+1); sp <- sp+2
    {
@@ -405,81 +423,81 @@ int State8080::Emulate8080Op()
       Reg.f.c = ((flags & (1 << 0)) == (1 << 0)); // Carry bit
 
       this->incrementPC(1);
-      return 10; // 10 cycles
+      return info.cycles;
    }
    case 0x09: // 0x09   DAD B       1     CY             HL = HL + BC
    {
       DAD(this, (Reg.b << 8) | Reg.c);
       this->incrementPC(1);
-      return 10; // 10 cycles
+      return info.cycles;
    }
    case 0x19: // 0x19   DAD D       1     CY             HL = HL + DE
    {
       DAD(this, (Reg.d << 8) | Reg.e);
       this->incrementPC(1);
-      return 10; // 10 cycles
+      return info.cycles;
    }
    case 0x29: // 0x29   DAD H       1     CY             HL = HL + HL
    {
       DAD(this, (Reg.h << 8) | Reg.l);
       this->incrementPC(1);
-      return 10; // 10 cycles
+      return info.cycles;
    }
    case 0x39: // 0x39   DAD SP      1     CY             HL = HL + SP
    {
       DAD(this, Reg.sp);
       this->incrementPC(1);
-      return 10; // 10 cycles
+      return info.cycles;
    }
 
    case 0x03: // 0x03   INX B       1                    BC <- BC + 1
    {
       INX(this, Reg.b, Reg.c);
       this->incrementPC(1);
-      return 5; // 5 cycles
+      return info.cycles;
    }
    case 0x13: // 0x13   INX D       1                    DE <- DE + 1
    {
       INX(this, Reg.d, Reg.e);
       this->incrementPC(1);
-      return 5; // 5 cycles
+      return info.cycles;
    }
    case 0x23: // 0x23   INX H       1                    HL <- HL + 1
    {
       INX(this, Reg.h, Reg.l);
       this->incrementPC(1);
-      return 5; // 5 cycles
+      return info.cycles;
    }
    case 0x33: // 0x33   INX SP      1                    SP = SP + 1
    {
       Reg.sp = Reg.sp + 1;
       this->incrementPC(1);
-      return 5; // 5 cycles
+      return info.cycles;
    }
 
    case 0x0B: // 0x0b   DCX B       1                    BC = BC - 1
    {
       DCX(this, Reg.b, Reg.c);
       this->incrementPC(1);
-      return 5; // 5 cycles
+      return info.cycles;
    }
    case 0x1B: // 0x1b   DCX D       1                    DE = DE - 1
    {
       DCX(this, Reg.d, Reg.e);
       this->incrementPC(1);
-      return 5; // 5 cycles
+      return info.cycles;
    }
    case 0x2B: // 0x2b   DCX H       1                    HL = HL - 1
    {
       DCX(this, Reg.h, Reg.l);
       this->incrementPC(1);
-      return 5; // 5 cycles
+      return info.cycles;
    }
    case 0x3B: // 0x3b   DCX SP      1                    SP = SP - 1
    {
       Reg.sp = Reg.sp - 1;
       this->incrementPC(1);
-      return 5; // 5 cycles
+      return info.cycles;
    }
 
    case 0xEB: // 0xeb   XCHG        1                    H <-> D; L <-> E
@@ -487,20 +505,20 @@ int State8080::Emulate8080Op()
       std::swap(Reg.h, Reg.d);
       std::swap(Reg.l, Reg.e);
       this->incrementPC(1);
-      return 5; // 5 cycles
+      return info.cycles;
    }
    case 0xE3: // 0xe3   XTHL        1                    L <-> (SP); H <-> (SP+1)
    {
       std::swap(Reg.l, memory[Reg.sp + 0]);
       std::swap(Reg.h, memory[Reg.sp + 1]);
       this->incrementPC(1);
-      return 18; // 18 cycles (Longest operation!)
+      return info.cycles; // Longest operation!
    }
    case 0xF9: // 0xf9   SPHL        1                    SP=HL
    {
       Reg.sp = (Reg.h << 8) | (Reg.l);
       this->incrementPC(1);
-      return 5; // 5 cycles
+      return info.cycles;
    }
 
    // IMMEDIATE INSTRUCTIONS: LXI, MVI, ADI, ACI, SUI, SBI, ANI, XRI, ORI, CPI
@@ -508,25 +526,25 @@ int State8080::Emulate8080Op()
    {
       LXI(this, Reg.b, Reg.c);
       this->incrementPC(3);
-      return 10; // 10 cycles
+      return info.cycles;
    }
    case 0x11: // 0x11   LXI DD16    3                    D <- byte 3 E <- byte 2
    {
       LXI(this, Reg.d, Reg.e);
       this->incrementPC(3);
-      return 10; // 10 cycles
+      return info.cycles;
    }
    case 0x21: // 0x21   LXI HD16    3                    H <- byte 3 L <- byte 2
    {
       LXI(this, Reg.h, Reg.l);
       this->incrementPC(3);
-      return 10; // 10 cycles
+      return info.cycles;
    }
    case 0x31: // 0x31   LXI SP D16  3                    SP.hi <- byte 3 SP.lo <- byte 2
    {
       Reg.sp = address();
       this->incrementPC(3);
-      return 10; // 10 cycles
+      return info.cycles;
    }
 
    case 0x06: // 0x06   MVI B D8    2                    B <- byte 2
@@ -541,7 +559,7 @@ int State8080::Emulate8080Op()
       int reg = CODE_1;
       getRegister(reg) = immediate(1);
       this->incrementPC(2);
-      return 7; // 7 cycles
+      return info.cycles;
    }
 
    case 0xC6: // 0xc6   ADI D8      2     Z S P CY AC    A <- A + byte
@@ -557,7 +575,7 @@ int State8080::Emulate8080Op()
       math[op](this, immediate());
 
       this->incrementPC(2);
-      return 7; // 7 cycles
+      return info.cycles;
    }
 
    // DIRECT ADDRESSING INSTRUCTIONS: STA, LDA, SHLD, LHLD
@@ -566,14 +584,14 @@ int State8080::Emulate8080Op()
       uint16_t adr = address();
       memory[adr] = Reg.a;
       this->incrementPC(3);
-      return 13; // 13 cycles
+      return info.cycles;
    }
    case 0x3A: // 0x3a   LDA adr     3                    A <- (adr)
    {
       uint16_t adr = address();
       Reg.a = memory[adr];
       this->incrementPC(3);
-      return 13; // 13 cycles
+      return info.cycles;
    }
    case 0x22: // 0x22   SHLD adr    3                    (adr) <-L; (adr+1)<-H
    {
@@ -581,7 +599,7 @@ int State8080::Emulate8080Op()
       memory[adr + 0] = Reg.l;
       memory[adr + 1] = Reg.h;
       this->incrementPC(3);
-      return 16; // 16 cycles
+      return info.cycles;
    }
    case 0x2A: // 0x2a   LHLD adr    3                    L <- (adr); H<-(adr+1)
    {
@@ -589,19 +607,19 @@ int State8080::Emulate8080Op()
       Reg.l = memory[adr + 0];
       Reg.h = memory[adr + 1];
       this->incrementPC(3);
-      return 16; // 16 cycles
+      return info.cycles;
    }
 
    // JUMP INSTRUCTIONS: PCHL, JMP, JC, JNC, JZ, JNZ, JM, JP, JPE, JPO
    case 0xE9: // 0xe9   PCHL        1                    pc.hi <- H; pc.lo <- L
    {
       Reg.pc = (Reg.h << 8) | (Reg.l << 0);
-      return 5; // 5 cycles
+      return info.cycles;
    }
    case 0xC3: // 0xc3   JMP adr     3                    pc <- adr
    {
       Reg.pc = address();
-      return 10; // 10 cycles
+      return info.cycles;
    }
    case 0xDA: // 0xda   JC  adr     3                    if C  pc <- adr
    case 0xD2: // 0xd2   JNC adr     3                    if NC pc <- adr
@@ -617,14 +635,14 @@ int State8080::Emulate8080Op()
          Reg.pc = address();
       else
          this->incrementPC(3);
-      return 10; // 10 cycles
+      return info.cycles;
    }
 
    // CALL SUBROUTINE INSTRUCTIONS: CALL, CC, CNC, CZ, CNZ, CM, CP, CPE, CPO
    case 0xCD: // 0xcd   CALL adr    3                    (SP-1) <- pc.hi; (SP-2) <- pc.lo; SP <- SP + 2; pc = adr
    {
       CALL(this, address());
-      return 17; // 17 cycles
+      return info.cycles;
    }
    case 0xDC: // 0xdc   CC  adr     3                    if C  CALL adr
    case 0xD4: // 0xd4   CNC adr     3                    if NC CALL adr
@@ -639,18 +657,18 @@ int State8080::Emulate8080Op()
       if (tests[test](this))
       {
          CALL(this, address());
-         return 17; // 17 cycles
+         return info.taken;
       }
 
       this->incrementPC(3);
-      return 11; // 11 cycles
+      return info.cycles;
    }
 
    // RETURN FROM SUBROUTINE INSTRUCTIONS: RET, RN, RNC, RZ, RNZ, RM, RP, RPE, RPO
    case 0xC9: // 0xc9   RET         1                    pc.lo <- (sp); pc.hi <- (sp + 1); SP <- SP + 2
    {
       RET(this);
-      return 10; // 10 cycles
+      return info.cycles;
    }
    case 0xD8: // 0xd8   RC          1                    if C  RET
    case 0xD0: // 0xd0   RNC         1                    if NC RET
@@ -665,11 +683,11 @@ int State8080::Emulate8080Op()
       if (tests[test](this))
       {
          RET(this);
-         return 11; // 11 cycles
+         return info.taken;
       }
       
       this->incrementPC(1);
-      return 5; // 5 cycles
+      return info.cycles;
    }
 
    // RST INSTRUCTION
@@ -683,7 +701,7 @@ int State8080::Emulate8080Op()
    case 0xFF: // 0xff   RST 7       1                    CALL $38
    {
       RST(this, opcode & 0x38); // opcode & 0x38 == (CODE_1) << 3
-      return 11; // 11 cycles
+      return info.cycles;
    }
 
    // INTERRUPT FLIP-FLOP INSTRUCTIONS
@@ -691,29 +709,31 @@ int State8080::Emulate8080Op()
    {  // Enable Interrupts
       interrupt_enabled = true;
       this->incrementPC(1);
-      return 4; // 4 cycles
+      return info.cycles;
    }
    case 0xF3: // 0xf3   DI          1                    special
    {  // Disable Interrupts
       interrupt_enabled = false;
       this->incrementPC(1);
-      return 4; // 4 cycles
+      return info.cycles;
    }
 
    // INPUT/OUTPUT INSTRUCTIONS: IN, OUT
    case 0xDB: // 0xdb   IN  D8      2                    special
    {  // Read input port into A
       uint8_t port = immediate();
+      instrumentation.portRead(port);
       Reg.a = io->read(port);
       this->incrementPC(2);
-      return 10; // 10 cycles
+      return info.cycles;
    }
    case 0xD3: // 0xd3   OUT D8      2                    special
    {  // Write A to ouput port
       uint8_t port = immediate();
+      instrumentation.portWrite(port);
       io->write(port, Reg.a);
       this->incrementPC(2);
-      return 10; // 10 cycles
+      return info.cycles;
    }
 
    // HLT HALT INSTRUCTION
@@ -721,14 +741,14 @@ int State8080::Emulate8080Op()
    {  // Halt processor
       this->incrementPC(1);
       stopped = true;
-      return 7; // 7 cycles
+      return info.cycles;
    }
 
    // unused
    default: // 0x08, 0x10, 0x18, 0x20, 0x28, 0x30, 0x38, 0xcb, 0xd9, 0xdd, 0xed, 0xfd
    {
       this->incrementPC(1);
-      return 4; // 4 cycles
+      return info.cycles;
    }
    }
 }
\ No newline at end of file
@@ -0,0 +1,92 @@
+#include "EmulationThread.h"
+
+#include <chrono>
+
+EmulationThread::EmulationThread(SpaceInvaders* game, FramePacer::ReferenceClock reference, void* context)
+   : game(game), period(game->getFrameCycles() * 1'000'000'000 / CLOCK_SPEED), pacer(period) // Exactly 2 MHz
+{
+   if (reference)
+      pacer.setReference(reference, context);
+   thread = std::thread(&EmulationThread::run, this);
+}
+
+EmulationThread::~EmulationThread()
+{
+   stop();
+}
+
+void EmulationThread::run()
+{
+   typedef std::chrono::steady_clock Clock;
+   const std::chrono::milliseconds speedWindow(500);
+
+   uint64_t number = 0;
+   bool turbo = false;
+   int lastMultiple = 1;
+   double speed = 1;
+   uint64_t windowFrames = 0;
+   Clock::time_point windowStart = Clock::now();
+
+   pacer.restart();
+   while (!stopping)
+   {
+      if (resetRequested.exchange(false))
+         game->reset();
+
+      if (isTurbo() != turbo)
+      {
+         turbo = !turbo;
+         game->setSilenced(turbo);
+      }
+      int multiple = turbo ? (int)turboMultiple : 1;
+      if (multiple != lastMultiple)
+      {
+         pacer.restart(); // New rate from here
+         lastMultiple = multiple;
+      }
+
+      // Frames nobody will see first, then the one that is published
+      VideoFrame& frame = frames.back();
+      frame.input = inputSerial.load(std::memory_order_acquire);
+      Clock::time_point start = Clock::now();
+      int emulated = 1;
+      if (multiple == 0)
+         for (; Clock::now() - start < period; emulated++)
+            game->runFrame(nullptr);
+      else
+         for (; emulated < multiple; emulated++)
+            game->runFrame(nullptr);
+      game->runFrame(frame.vram);
+      Clock::time_point end = Clock::now();
+
+      windowFrames += emulated;
+      if (end - windowStart >= speedWindow)
+      {
+         speed = windowFrames * std::chrono::duration<double>(period).count() / std::chrono::duration<double>(end - windowStart).count();
+         windowFrames = 0;
+         windowStart = end;
+      }
+
+      frame.emulationMs = std::chrono::duration<double, std::milli>(end - start).count() / emulated;
+      frame.speed = speed;
+      frame.number = ++number;
+      frames.publish();
+
+      if (multiple != 0)
+         pacer.wait(); // Unlimited fast forward is paced by the work itself
+   }
+}
+
+bool EmulationThread::acquire()
+{
+   if (!frames.update())
+   {
+      if (shown != 0)
+         duplicated++;
+      return false;
+   }
+   const VideoFrame& newest = frames.front();
+   dropped += newest.number - shown - 1;
+   shown = newest.number;
+   return true;
+}
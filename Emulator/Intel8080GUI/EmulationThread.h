@@ -0,0 +1,85 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <thread>
+
+#include "../Common/FramePacer.h"
+#include "../Common/TripleBuffer.h"
+#include "SpaceInvaders.h"
+
+#include "stdafx.h"
+
+// One emulated frame as handed to the render thread
+struct VideoFrame
+{
+   uint8_t vram[0x1c00];  // Screen at the end of the frame (run-ahead included)
+   uint64_t number;       // 1, 2, 3... in publishing order
+   uint32_t input;        // Input serial the frame started with, see EmulationThread::inputChanged
+   double emulationMs;    // Host time spent emulating a frame (averaged over fast forwarded ones)
+   double speed;          // Emulated time / host time recently, 1 at normal speed
+};
+
+// Runs the game on its own thread at the emulated frame rate, paced by its
+// own FramePacer (optionally following a reference clock such as the sound
+// card's), and publishes every finished frame through a triple buffer. The
+// main thread handles events and presents whatever frame is newest, so a
+// slow present (vsync, compositor) never holds up emulation or sound.
+class EmulationThread
+{
+public:
+   EmulationThread(SpaceInvaders* game, FramePacer::ReferenceClock reference = nullptr, void* context = nullptr);
+   ~EmulationThread();
+
+   // Main thread
+   void requestReset() { resetRequested = true; }
+   // Call after every input change; returns its serial. A frame whose
+   // `input` is at least this serial was emulated with the change applied.
+   uint32_t inputChanged() { return inputSerial.fetch_add(1, std::memory_order_release) + 1; }
+
+   // Fast forward while held or toggled on: `multiple` frames per display
+   // frame, or 0 for as many as the host can run. Only the last frame of
+   // each batch is captured and published, and sound is silenced.
+   void setTurboHeld(bool held) { turboHeld = held; }
+   void toggleTurbo() { turboToggled = !turboToggled; }
+   void setTurboMultiple(int multiple) { turboMultiple = multiple; }
+   bool isTurbo() { return turboHeld || turboToggled; }
+   int getTurboMultiple() { return turboMultiple; }
+
+   // Main thread: takes the newest frame if there is one and counts frames
+   // that were never shown (dropped) and presents without a new frame
+   // (duplicated). Returns true for a new frame.
+   bool acquire();
+   const VideoFrame& frame() { return frames.front(); }
+   uint64_t getDropped() { return dropped; }
+   uint64_t getDuplicated() { return duplicated; }
+
+   // Stops the game; the pacing report is complete after this
+   void stop()
+   {
+      stopping = true;
+      if (thread.joinable())
+         thread.join();
+   }
+   void report(std::ostream& stream) { pacer.report(stream, "Emulation"); }
+
+private:
+   void run();
+
+   SpaceInvaders* game;
+   TripleBuffer<VideoFrame> frames;
+   std::chrono::nanoseconds period; // One emulated frame
+   FramePacer pacer;
+   std::atomic<bool> resetRequested{ false };
+   std::atomic<bool> turboHeld{ false };
+   std::atomic<bool> turboToggled{ false };
+   std::atomic<int> turboMultiple{ 0 };
+   std::atomic<uint32_t> inputSerial{ 0 };
+   std::atomic<bool> stopping{ false };
+   std::thread thread;
+
+   uint64_t shown = 0;       // Number of the frame on screen
+   uint64_t dropped = 0;
+   uint64_t duplicated = 0;
+};
@@ -4,75 +4,108 @@
 #include <SDL_mixer.h>
 #include <string>
 
+#include "../Common/Devices.h"
+#include "../Common/IOBus.h"
+#include "AudioThread.h"
+
 #include "stdafx.h"
 
-class IO
+// Sound latches on ports 3 and 5. OUT only looks for bits that changed and
+// hands those edges, stamped with the emulated cycle, to the audio thread.
+class MixerSound
 {
 public:
-   uint8_t read(uint8_t port);
-   void write(uint8_t port, uint8_t value);
-
-   IO() {}
-   IO(WAV* sounds) : sounds(sounds) {}
-   IO(char** soundFiles)
+   MixerSound() {}
+   MixerSound(WAV* sounds) : sounds(sounds) { start(); }
+   MixerSound(char** soundFiles)
    {
-      sounds = new WAV[9];
+      sounds = new WAV[9]();
       for (auto sound = 0; sound < 9; sound++)
          if ((sounds[sound] = Mix_LoadWAV(soundFiles[sound])) == nullptr)
             throw std::string("Failed to load sound effect! Mix_LoadWAV error: ") + SDL_GetError();
+      start();
    }
-   ~IO()
+   ~MixerSound()
    {
+      delete audio; // Stop playing before the samples go away
+
       // Free sound effects
       if (sounds != nullptr)
          for (auto sound = 0; sound < 9; sound++)
             Mix_FreeChunk(sounds[sound]);
       delete[] sounds;
-      Mix_Quit();
    }
 
-   struct Read1
-   {
-      uint8_t coin = 1; // Coin (0 when active)
-      uint8_t player2Start = 0;
-      uint8_t player1Start = 0;
-      uint8_t fill1 = 0; // ?
-      uint8_t player1Shoot = 0;
-      uint8_t player1joystickLeft = 0;
-      uint8_t player1joystickRight = 0;
-      uint8_t fill2 = 0; // ?
-   } Read1;
-   struct Read2
-   {
-      uint8_t lives = 3; // Dipswitch number of lives (0:3,1:4,2:5,3:6)
-      uint8_t tilt = 0; // Tilt 'button'
-      uint8_t bonusLife = 0; // Dipswitch bonus life at 1:1000,0:1500    
-      uint8_t player2Shoot = 0;
-      uint8_t player2joystickLeft = 0;
-      uint8_t player2joystickRight = 0;
-      uint8_t coinInfo = 0; // Dipswitch coin info 1:off,0:on  
-   } Read2;
-
-   void setLives(int value) { Read2.lives = value & 3; }
-   void setCoin()      { Read1.coin                 = 1; } void resetCoin()      { Read1.coin                 = 0; }
-   void setTilt()      { Read2.tilt                 = 1; } void resetTilt()      { Read2.tilt                 = 0; }
-   void setBonusLife() { Read2.bonusLife            = 1; } void resetBonusLife() { Read2.bonusLife            = 0; }
-   void setCoinInfo()  { Read2.coinInfo             = 1; } void resetCoinInfo()  { Read2.coinInfo             = 0; }
-
-   void setP1Start()   { Read1.player1Start         = 1; } void resetP1Start()   { Read1.player1Start         = 0; }
-   void setP1Shoot()   { Read1.player1Shoot         = 1; } void resetP1Shoot()   { Read1.player1Shoot         = 0; }
-   void setP1Left()    { Read1.player1joystickLeft  = 1; } void resetP1Left()    { Read1.player1joystickLeft  = 0; }
-   void setP1Right()   { Read1.player1joystickRight = 1; } void resetP1Right()   { Read1.player1joystickRight = 0; }
-                                                                                 
-   void setP2Start()   { Read1.player2Start         = 1; } void resetP2Start()   { Read1.player2Start         = 0; }
-   void setP2Shoot()   { Read2.player2Shoot         = 1; } void resetP2Shoot()   { Read2.player2Shoot         = 0; }
-   void setP2Left()    { Read2.player2joystickLeft  = 1; } void resetP2Left()    { Read2.player2joystickLeft  = 0; }
-   void setP2Right()   { Read2.player2joystickRight = 1; } void resetP2Right()   { Read2.player2joystickRight = 0; }
+   void attach(IOBus& bus, uint8_t port3 = 3, uint8_t port5 = 5);
+
+   // Emulated cycle counter used to timestamp events
+   void setClock(const uint64_t* clock) { this->clock = clock; }
+
+   // Run-ahead: the latches are saved and restored with the machine, and
+   // while muted edges are still latched but never reach the audio thread
+   struct Latches { uint8_t port3, port5; };
+   Latches save() const { return { port3, port5 }; }
+   void restore(const Latches& latches) { port3 = latches.port3; port5 = latches.port5; }
+   void setMuted(bool muted) { this->muted = muted; }
+
+   // Fast forward: no sound at all until turned back on. Unlike muting, a
+   // playing UFO loop is stopped (and restarted if it is still on after).
+   void setSilenced(bool silenced);
+
 private:
-   WAV* sounds;
+   void start() { audio = new AudioThread(sounds); }
+   void latch(uint8_t& latched, uint8_t value, int sounds, int first);
+
+   WAV* sounds = nullptr;
+   AudioThread* audio = nullptr;
+   const uint64_t* clock = nullptr;
+   bool muted = false;
+   bool silenced = false;
 
-   uint8_t shift_offset;
+   uint8_t port3 = 0;
+   uint8_t port5 = 0;
+};
 
-   uint8_t shift0;
-   uint8_t shift1;
+// Space Invaders I/O board for the SDL build
+class IO : public IOBus
+{
+public:
+   IO() { attachDevices(); }
+   IO(WAV* sounds) : sound(sounds) { attachDevices(); }
+   IO(char** soundFiles) : sound(soundFiles) { attachDevices(); }
+   ~IO() { Mix_Quit(); }
+
+   ShiftRegister shifter;
+   InputPorts inputs;
+   MixerSound sound;
+   Watchdog watchdog;
+   DebugConsole console;
+
+   // Input state lives in the packed, atomic port bytes so these can be
+   // called from any thread
+   void setLives(int value) { inputs.assign(2, InputPorts::LIVES, value & 3); }
+   void setCoin()      { inputs.set(1, InputPorts::COIN);       } void resetCoin()      { inputs.reset(1, InputPorts::COIN);       }
+   void setTilt()      { inputs.set(2, InputPorts::TILT);       } void resetTilt()      { inputs.reset(2, InputPorts::TILT);       }
+   void setBonusLife() { inputs.set(2, InputPorts::BONUS_LIFE); } void resetBonusLife() { inputs.reset(2, InputPorts::BONUS_LIFE); }
+   void setCoinInfo()  { inputs.set(2, InputPorts::COIN_INFO);  } void resetCoinInfo()  { inputs.reset(2, InputPorts::COIN_INFO);  }
+
+   void setP1Start()   { inputs.set(1, InputPorts::P1_START);   } void resetP1Start()   { inputs.reset(1, InputPorts::P1_START);   }
+   void setP1Shoot()   { inputs.set(1, InputPorts::P1_SHOOT);   } void resetP1Shoot()   { inputs.reset(1, InputPorts::P1_SHOOT);   }
+   void setP1Left()    { inputs.set(1, InputPorts::P1_LEFT);    } void resetP1Left()    { inputs.reset(1, InputPorts::P1_LEFT);    }
+   void setP1Right()   { inputs.set(1, InputPorts::P1_RIGHT);   } void resetP1Right()   { inputs.reset(1, InputPorts::P1_RIGHT);   }
+
+   void setP2Start()   { inputs.set(1, InputPorts::P2_START);   } void resetP2Start()   { inputs.reset(1, InputPorts::P2_START);   }
+   void setP2Shoot()   { inputs.set(2, InputPorts::P2_SHOOT);   } void resetP2Shoot()   { inputs.reset(2, InputPorts::P2_SHOOT);   }
+   void setP2Left()    { inputs.set(2, InputPorts::P2_LEFT);    } void resetP2Left()    { inputs.reset(2, InputPorts::P2_LEFT);    }
+   void setP2Right()   { inputs.set(2, InputPorts::P2_RIGHT);   } void resetP2Right()   { inputs.reset(2, InputPorts::P2_RIGHT);   }
+
+private:
+   void attachDevices()
+   {
+      console.attach(*this);  // Port 0 out
+      inputs.attach(*this);   // Ports 1, 2 in
+      shifter.attach(*this);  // Ports 2, 4 out, 3 in
+      sound.attach(*this);    // Ports 3, 5 out
+      watchdog.attach(*this); // Port 6 out
+   }
 };
\ No newline at end of file
@@ -0,0 +1,47 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+
+// Input to present latency. The first input event not yet on screen starts
+// the clock (SDL event timestamps, ms since SDL_Init); presenting the first
+// frame emulated with that input stops it. Inputs are numbered by
+// EmulationThread::inputChanged and frames carry the number they started
+// with. The monitor's own scanout and response time come on top of this,
+// but everything the emulator controls is inside it.
+class LatencyMeter
+{
+public:
+   void input(uint32_t timestamp, uint32_t serial)
+   {
+      if (!pending)
+      {
+         pending = true;
+         since = timestamp;
+         waitingFor = serial;
+      }
+   }
+
+   void presented(uint32_t now, uint32_t frameInput)
+   {
+      if (!pending || (int32_t)(frameInput - waitingFor) < 0)
+         return;
+      pending = false;
+      uint32_t latency = now - since;
+      total += latency;
+      worst = std::max(worst, latency);
+      samples++;
+   }
+
+   uint32_t getSamples() { return samples; }
+   double getAverage() { return samples ? (double)total / samples : 0; }
+   uint32_t getWorst() { return worst; }
+   void clear() { total = worst = samples = 0; }
+
+private:
+   bool pending = false;
+   uint32_t since = 0;
+   uint32_t waitingFor = 0;
+   uint64_t total = 0;
+   uint32_t worst = 0;
+   uint32_t samples = 0;
+};
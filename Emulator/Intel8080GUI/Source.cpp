@@ -1,9 +1,13 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
 #include <iostream>
 #include <string>
-#include <vector>
 
 #include "Application.h"
-#include "LTimer.h"
+#include "AudioClock.h"
+#include "EmulationThread.h"
+#include "LatencyMeter.h"
 #include "SpaceInvaders.h"
 
 #include "stdafx.h"
@@ -30,16 +34,36 @@ int main(int argc, char** argv)
    else
       game = new SpaceInvaders(argv[1]);
 
-   std::vector<unsigned char> pixels(WIDTH * HEIGHT * 4, 0); // Game video
+   Symbols symbols;
+   try
+   {
+      symbols.loadDefault(argv[0], std::cerr);
+   }
+   catch (const std::string& msg)
+   {
+      std::cout << msg << std::endl;
+      return 1;
+   }
+   game->setSymbols(&symbols);
+
+   // With sound, emulation follows the sound card's clock
+   AudioClock* audioClock = argc == 2 + 9 ? new AudioClock() : nullptr;
+   EmulationThread* emulation = audioClock && audioClock->isRunning()
+      ? new EmulationThread(game, &AudioClock::seconds, audioClock)
+      : new EmulationThread(game); // Starts running the game
+
    bool quit = false; // Main loop flag
    SDL_Event event; // Event handler
-   LTimer capTimer; // The frames per second cap timer
+   FramePacer pacer(std::chrono::nanoseconds(1'000'000'000 / SCREEN_FPS)); // Presents
+
+   // Host time spent emulating (real plus run-ahead frames), shown in the title
+   const int TITLE_FRAMES = 30;
+   double emulationMs = 0, worstMs = 0;
+   int measuredFrames = 0, presentedFrames = 0;
+   LatencyMeter latency; // Input event to present
 
    while (!quit) // While application is running
    {
-      // Start cap timer
-      capTimer.start();
-
       // Handle events on queue
       while (SDL_PollEvent(&event) != 0)
       {
@@ -47,24 +71,69 @@ int main(int argc, char** argv)
          if (event.type == SDL_QUIT)
             quit = true;
          else if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_r)
-            game->reset();
+            emulation->requestReset();
+         else if (event.type == SDL_KEYDOWN && event.key.keysym.sym >= SDLK_0 && event.key.keysym.sym <= SDLK_3)
+            game->setRunAhead(event.key.keysym.sym - SDLK_0); // 0-3 frames of run-ahead
+         else if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_b)
+         {
+            int bands = game->getBands(); // Next scan band count: 1, 2, 4, 7, 14, 28, 1...
+            while (!game->setBands(bands = bands % 28 + 1))
+               ;
+         }
+         else if ((event.type == SDL_KEYDOWN || event.type == SDL_KEYUP) && event.key.keysym.sym == SDLK_TAB)
+            emulation->setTurboHeld(event.type == SDL_KEYDOWN); // Fast forward while held
+         else if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_f && !event.key.repeat)
+            emulation->toggleTurbo();
+         else if (event.type == SDL_KEYDOWN && event.key.keysym.sym >= SDLK_F1 && event.key.keysym.sym <= SDLK_F4)
+         {
+            static const int multiples[] = { 0, 2, 4, 8 }; // F1: unlimited, F2-F4: 2x, 4x, 8x
+            emulation->setTurboMultiple(multiples[event.key.keysym.sym - SDLK_F1]);
+         }
          else
+         {
             game->handleInput(event);
+            if (event.type == SDL_KEYDOWN || event.type == SDL_KEYUP)
+               latency.input(event.key.timestamp, emulation->inputChanged());
+         }
       }
 
-      // Run game for another frame
-      game->CPU_Cycles();
-
-      // Render what we want
-      game->draw(pixels);
+      // Show the newest emulated frame, converted straight into the texture
+      bool fresh = emulation->acquire();
+      const VideoFrame& frame = emulation->frame();
+      int pitch;
+      uint32_t* pixels = app->lock(pitch);
+      Framebuffer::convert(frame.vram, pixels, pitch);
+      app->present();
+      if (fresh)
+      {
+         latency.presented(SDL_GetTicks(), frame.input);
+         emulationMs += frame.emulationMs;
+         worstMs = std::max(worstMs, frame.emulationMs);
+         measuredFrames++;
+      }
 
-      app->update(pixels, WIDTH * 4);
+      if (++presentedFrames == TITLE_FRAMES)
+      {
+         char title[256];
+         std::snprintf(title, sizeof(title), "Space Invaders%s - x%.1f - run-ahead %d - %d bands - %.2f ms/frame (worst %.2f) - input latency %.1f ms (worst %u) - dropped %llu, duplicated %llu",
+            emulation->isTurbo() ? " - FAST FORWARD" : "", emulation->frame().speed,
+            game->getRunAhead(), game->getBands(), measuredFrames ? emulationMs / measuredFrames : 0, worstMs, latency.getAverage(), latency.getWorst(),
+            (unsigned long long)emulation->getDropped(), (unsigned long long)emulation->getDuplicated());
+         app->setTitle(title);
+         emulationMs = worstMs = 0;
+         measuredFrames = presentedFrames = 0;
+         latency.clear();
+      }
 
-      int frameTicks = capTimer.getTicks(); // Get frame time
-      if (frameTicks < SCREEN_TICK_PER_FRAME) // If frame finished early
-         SDL_Delay(SCREEN_TICK_PER_FRAME - frameTicks); // Wait remaining time
+      pacer.wait();
    }
 
+   emulation->stop(); // Stop the game before it goes away
+   emulation->report(std::cout);
+   pacer.report(std::cout, "Render");
+   Instrumentation::writeSummary(std::cout, game->getCounters());
+   delete emulation;
+   delete audioClock;
    delete game;
    delete app;
 
@@ -1,5 +1,11 @@
 #pragma once
-#include <vector>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <memory>
+
+#include "../Common/Framebuffer.h"
+#include "../Common/Symbols.h"
 
 #include "stdafx.h"
 #include "State8080.h"
@@ -13,6 +19,7 @@ public:
       try
       {
          io = new IO(soundFiles);
+         io->sound.setClock(&cycles);
          state = new State8080(file, io);
       }
       catch (const std::string& msg)
@@ -39,14 +46,116 @@ public:
    }
 
    void reset() { state->reset(); }
+   void setSymbols(const Symbols* symbols) { state->setSymbols(symbols); } // Names for the disassembler
+
+   // Machine state that run-ahead rolls back. Inputs are left alone: they
+   // are the live controls the speculative frames should see.
+   struct Snapshot
+   {
+      State8080::Snapshot cpu;
+      ShiftRegister shifter;
+      Watchdog watchdog;
+      MixerSound::Latches sound;
+      Uint64 nextInterrupt;
+      Uint64 cycles;
+   };
+   void save(Snapshot& snapshot) const
+   {
+      state->save(snapshot.cpu);
+      snapshot.shifter = io->shifter;
+      snapshot.watchdog = io->watchdog;
+      snapshot.sound = io->sound.save();
+      snapshot.nextInterrupt = nextInterrupt;
+      snapshot.cycles = cycles;
+   }
+   void restore(const Snapshot& snapshot)
+   {
+      state->restore(snapshot.cpu);
+      io->shifter = snapshot.shifter;
+      io->watchdog = snapshot.watchdog;
+      io->sound.restore(snapshot.sound);
+      nextInterrupt = snapshot.nextInterrupt;
+      cycles = snapshot.cycles;
+   }
+
+   // Run-ahead: frames emulated past the real one with the current input,
+   // shown, then thrown away. The game only acts on input a frame or more
+   // after it polls it; showing a future frame hides that delay. Sound only
+   // comes from the real timeline. Safe to call from any thread; takes
+   // effect on the next frame.
+   void setRunAhead(int frames) { runAheadFrames = std::max(0, std::min(frames, MAX_RUN_AHEAD)); }
+   int getRunAhead() { return runAheadFrames; }
 
-   void CPU_Cycles() // Run CPU for 1/60s or two video interrupts
+   void setSilenced(bool silenced) { io->sound.setSilenced(silenced); } // Emulation thread
+
+   // Counters of the CPU over the real frames; run-ahead rolls its own
+   // back. Read them once the emulation thread has stopped.
+   Counters getCounters() { return state->getInstrumentation().snapshot(); }
+
+   Uint64 getFrameCycles() { return 2 * (Uint64)howOftenToInterrupt; } // Two video interrupts
+
+   // Runs one frame and copies the screen (0x1c00 bytes of VRAM) to `vram`
+   // band by band as it is scanned, see CPU_Cycles. Without `vram` (fast
+   // forward frames that are never shown) it only emulates.
+   void runFrame(uint8_t* vram)
    {
+      state->getInstrumentation().frame();
+      int frames = runAheadFrames;
+      if (frames == 0 || vram == nullptr) // Nobody will see run-ahead frames that are not captured
+      {
+         CPU_Cycles(vram);
+         return;
+      }
+
+      CPU_Cycles(); // The real frame
+      save(*runAhead);
+      io->sound.setMuted(true);
+      for (int frame = 0; frame < frames; frame++)
+         CPU_Cycles(frame == frames - 1 ? vram : nullptr);
+      io->sound.setMuted(false);
+      restore(*runAhead);
+   }
+
+   // The screen is scanned in `bands` bands of VRAM lines spread evenly
+   // over the frame (224 lines, so 1, 2, 4, 7, 14 or 28 bands of 8 lines or
+   // more). Like the hardware, the half drawn before RST 1 is the first half
+   // of VRAM and the rest is drawn before RST 2; the game moves things in the
+   // half that is not being drawn to avoid tearing. Safe to call from any
+   // thread; takes effect on the next frame.
+   bool setBands(int bands)
+   {
+      if (bands < 1 || SCAN_LINES % bands != 0 || (SCAN_LINES / bands) % 8 != 0)
+         return false;
+      scanBands = bands;
+      return true;
+   }
+   int getBands() { return scanBands; }
+
+   // Run CPU for 1/60s or two video interrupts. With `vram`, each band is
+   // copied there at the emulated cycle it finishes scanning.
+   void CPU_Cycles(uint8_t* vram = nullptr)
+   {
+      const uint8_t* screen = &state->memory[Framebuffer::VRAM];
+      Uint64 frameStart = nextInterrupt - howOftenToInterrupt;
+      Uint64 frameLength = 2 * (Uint64)howOftenToInterrupt;
+      int bands = vram ? (int)scanBands : 0;
+      int linesPerBand = bands ? SCAN_LINES / bands : 0;
+      int band = 0;
+      Uint64 bandEnd = bands ? frameStart + frameLength / bands : 0;
+
       bool firstInterrupt = true;
       for (;;)
       {
          cycles += state->Emulate8080Op();
 
+         while (band < bands && cycles >= bandEnd) // Drawn before the interrupt that ends it
+         {
+            size_t offset = 32 * band * linesPerBand;
+            std::memcpy(vram + offset, screen + offset, 32 * linesPerBand);
+            band++;
+            bandEnd = frameStart + frameLength * (band + 1) / bands;
+         }
+
          if (cycles >= nextInterrupt)
          {
             nextInterrupt += howOftenToInterrupt;
@@ -107,27 +216,19 @@ public:
          }
    }
 
-   void draw(std::vector<unsigned char> &pixels) { // Assumes pixels has dimensions WIDTH*HEIGHT*4
-      for (unsigned int row = 0; row < HEIGHT; row++)
-         for (unsigned int col = 0; col < WIDTH; col++)
-         {
-            unsigned int offset = (WIDTH * 4 * row) + col * 4; // Get pixel in vector
-
-            uint8_t byte = state->memory[0x2400 + HEIGHT / 8 * col + (0x1F - (row) / 8)]; // row is reverse so first row (0x1F) minus (row/8) because 1 byte has 8 rows (bits)
-            uint8_t pixel = byte & (1 << (7 - row % 8)); // Select pixel in byte
-
-            pixels[offset + 0] = (pixel ? 0xFF : 0x00);
-            pixels[offset + 1] = (pixel ? 0xFF : 0x00);
-            pixels[offset + 2] = (pixel ? 0xFF : 0x00);
-            pixels[offset + 3] = SDL_ALPHA_OPAQUE;
-         }
-   }
 private:
 
+   static const int MAX_RUN_AHEAD = 3;
+   static const int SCAN_LINES = Framebuffer::WIDTH; // VRAM lines of 32 bytes
+
    State8080* state;
    IO* io;
 
-   int howOftenToInterrupt = 2'000'000 / 120;
+   std::atomic<int> runAheadFrames{ 0 };
+   std::atomic<int> scanBands{ 2 };
+   std::unique_ptr<Snapshot> runAhead = std::make_unique<Snapshot>(); // 64K, keep it off the stack
+
+   int howOftenToInterrupt = CLOCK_SPEED / 120;
    Uint64 nextInterrupt = 0 + howOftenToInterrupt;
    Uint64 cycles = 0; // Counter will overflow in about 250K years
 };
\ No newline at end of file
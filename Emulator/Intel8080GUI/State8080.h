@@ -1,7 +1,9 @@
 #pragma once
 #include "IO.h"
+#include "../Common/Instrumentation.h"
 
 #include <cstdint> // uint8_t, uint16_t, uint32_t
+#include <cstring>
 #include <fstream>
 
 #define SET 1
@@ -14,6 +16,8 @@
 
 uint8_t parity(uint8_t v);
 
+class Symbols;
+
 class State8080 {
 public:
    struct Reg
@@ -43,12 +47,54 @@ public:
       reset();
    }
 
+   void setSymbols(const Symbols* symbols) { this->symbols = symbols; } // Names for Disassemble8080Op
+   // Counts the emulated instructions; save/restore carry its counts so
+   // frames rolled back by run-ahead are not counted
+   Instrumentation& getInstrumentation() { return instrumentation; }
+
    int  Emulate8080Op();
    int  Disassemble8080Op();
    void displayFull();
    void displayAbrev();
    bool isStopped() { return stopped; }
 
+   // Everything needed to put the CPU and memory back exactly where they
+   // were; plain data so save/restore are a couple of memcpys (run-ahead
+   // does both every frame)
+   struct Snapshot
+   {
+      decltype(State8080::Reg) reg;
+      uint8_t memory[0x10000];
+      bool interrupt_enabled;
+      bool interruptRequested;
+      unsigned char interruptOpcode;
+      bool stopped;
+      bool updatePC;
+      Instrumentation::Snapshot instrumentation;
+   };
+   void save(Snapshot& snapshot) const
+   {
+      snapshot.reg = Reg;
+      std::memcpy(snapshot.memory, memory, sizeof(memory));
+      snapshot.interrupt_enabled = interrupt_enabled;
+      snapshot.interruptRequested = interruptRequested;
+      snapshot.interruptOpcode = interruptOpcode;
+      snapshot.stopped = stopped;
+      snapshot.updatePC = updatePC;
+      instrumentation.save(snapshot.instrumentation);
+   }
+   void restore(const Snapshot& snapshot)
+   {
+      Reg = snapshot.reg;
+      std::memcpy(memory, snapshot.memory, sizeof(memory));
+      interrupt_enabled = snapshot.interrupt_enabled;
+      interruptRequested = snapshot.interruptRequested;
+      interruptOpcode = snapshot.interruptOpcode;
+      stopped = snapshot.stopped;
+      updatePC = snapshot.updatePC;
+      instrumentation.restore(snapshot.instrumentation);
+   }
+
    void reset()
    {
       Reg.pc = 0;
@@ -82,7 +128,6 @@ public:
          Reg.pc += inc;
       return Reg.pc;
    }
-   void report(std::ostream &stream);
    void memDump(const char* file)
    {
       std::ofstream stream(file, std::ios::binary);
@@ -90,11 +135,16 @@ public:
       stream.close();
    }
 private:
+   static const int HALT_CYCLES = 4; // Halted, the CPU looks for an interrupt this often
+
+   int execute(uint8_t opcode); // Emulate8080Op after the fetch
+
    IO *io;
+   const Symbols* symbols = nullptr;
+   Instrumentation instrumentation;
    bool interrupt_enabled = false;  // Are we ready to take interrupts?
    bool interruptRequested = false; // Is there an interrupt now?
    unsigned char interruptOpcode = 0;
    bool stopped = false;
-   long int hitCount[256] = {};
    bool updatePC = true;
 };
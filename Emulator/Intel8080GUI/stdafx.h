@@ -11,7 +11,8 @@
 const int WIDTH = 224;
 const int HEIGHT = 256;
 
+const int CLOCK_SPEED = 2'000'000; // 8080 cycles per second
+
 const int SCREEN_FPS = 60;
-const int SCREEN_TICK_PER_FRAME = 1000 / SCREEN_FPS;
 
 typedef Mix_Chunk* WAV; // Used for .wav files a lot
\ No newline at end of file
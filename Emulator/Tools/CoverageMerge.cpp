@@ -0,0 +1,309 @@
+// ORs the coverage bitmaps of many runs (Intel8080 -coverage) and reports
+// what none of them reached.
+//
+// Usage: CoverageMerge <rom> <coverage>... [-list file] [-out file]
+//                      [-listing file] [-symbols file] [-nocache]
+//
+// -list reads more coverage file names from a file, one per line, for
+// batches too big for a command line. -out saves the merged bitmaps, which
+// can be merged again later. Runs of another ROM are left out.
+//
+// Prints how much of the ROM was executed, read as data or never touched,
+// how much of the code the static analysis finds ran, how much of the RAM
+// was read and written, and the routines and RAM ranges nobody reached.
+// -listing writes the whole ROM disassembled (see Common/Analysis.h) with a
+// column in front of every line:
+//
+//    X  executed         -  code that never ran
+//    R  data read        .  data never read
+//
+// Names come from Common/invaders.sym unless -symbols gives another map.
+
+#include "../Common/Analysis.h"
+#include "../Common/Coverage.h"
+#include "../Common/Opcodes.h"
+#include "../Common/Symbols.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+std::vector<uint8_t> rom;
+Analysis analysis;
+Symbols symbols;
+Coverage merged, run; // 192KB each, not for the stack
+
+std::string hex(unsigned value, int digits)
+{
+   std::string text;
+   Opcodes::appendHex(text, value, digits);
+   return text;
+}
+
+std::string percent(uint32_t part, uint32_t whole)
+{
+   std::ostringstream text;
+   text << std::fixed << std::setprecision(1) << (whole ? part * 100.0 / whole : 0.0) << "%";
+   return text.str();
+}
+
+std::string routineName(uint16_t address)
+{
+   const Symbols::Symbol* symbol = symbols.at(address, Symbols::CODE);
+   return symbol ? symbol->name : "sub_" + hex(address, 4);
+}
+
+// Symbol names, then sub_xxxx for the other routines
+const char* operandName(uint16_t address, Opcodes::Operand kind, void*)
+{
+   static std::string name;
+   if (const char* symbol = Symbols::lookup(address, kind, &symbols))
+      return symbol;
+   if (kind != Opcodes::OPERAND_TARGET || !analysis.isRoutine(address))
+      return nullptr;
+   name = routineName(address);
+   return name.c_str();
+}
+
+// "2010-2011 name, 20c5 name" for the runs of addresses in [from, to) that
+// no run read or wrote
+void writeUntouched(std::ostream& out, uint32_t from, uint32_t to)
+{
+   auto touched = [](uint32_t address) {
+      return merged.test(Coverage::READ, (uint16_t)address) || merged.test(Coverage::WRITTEN, (uint16_t)address);
+   };
+   int column = 0;
+   uint32_t address = from;
+   while (address < to)
+   {
+      if (touched(address))
+      {
+         address++;
+         continue;
+      }
+      uint32_t end = address;
+      while (end < to && !touched(end))
+         end++;
+      std::string range = hex(address, 4) + (end - address > 1 ? "-" + hex(end - 1, 4) : "");
+      std::string name = symbols.describe((uint16_t)address);
+      out << (column % 6 == 0 ? "\n   " : ", ") << range << (name.empty() ? "" : " " + name);
+      column++;
+      address = end;
+   }
+   out << std::endl;
+}
+
+void writeSummary(std::ostream& out)
+{
+   uint32_t size = (uint32_t)rom.size();
+   uint32_t executed = merged.count(Coverage::EXECUTED, 0, size);
+   uint32_t touched = 0, readOnly = 0, code = 0, codeExecuted = 0;
+   for (uint32_t address = 0; address < size; address++)
+   {
+      bool ran = merged.test(Coverage::EXECUTED, (uint16_t)address);
+      bool read = merged.test(Coverage::READ, (uint16_t)address);
+      touched += ran || read;
+      readOnly += read && !ran;
+      if (analysis.kind[address] == Analysis::CODE || analysis.kind[address] == Analysis::OPERAND)
+      {
+         code++;
+         codeExecuted += ran;
+      }
+   }
+
+   std::vector<uint16_t> missed;
+   for (uint16_t routine : analysis.routines)
+      if (routine < size && !merged.test(Coverage::EXECUTED, routine))
+         missed.push_back(routine);
+   uint32_t routines = (uint32_t)analysis.routines.size();
+
+   out << "ROM " << hex(0, 4) << "-" << hex(size - 1, 4) << ": executed " << executed << " bytes (" << percent(executed, size)
+      << "), only read as data " << readOnly << " (" << percent(readOnly, size)
+      << "), never touched " << size - touched << " (" << percent(size - touched, size) << ")" << std::endl
+      << "   code found by analysis " << code << " bytes, executed " << codeExecuted << " (" << percent(codeExecuted, code) << ")" << std::endl
+      << "   routines entered " << routines - missed.size() << " of " << routines << " (" << percent(routines - (uint32_t)missed.size(), routines) << ")" << std::endl;
+
+   // RAM: from the end of the ROM to the mirror at 0x4000
+   uint32_t ramEnd = std::max<uint32_t>(size, 0x4000);
+   uint32_t ram = ramEnd - size;
+   uint32_t read = merged.count(Coverage::READ, size, ramEnd);
+   uint32_t written = merged.count(Coverage::WRITTEN, size, ramEnd);
+   uint32_t untouched = 0;
+   for (uint32_t address = size; address < ramEnd; address++)
+      untouched += !merged.test(Coverage::READ, (uint16_t)address) && !merged.test(Coverage::WRITTEN, (uint16_t)address);
+   if (ram)
+      out << "RAM " << hex(size, 4) << "-" << hex(ramEnd - 1, 4) << ": read " << read << " bytes (" << percent(read, ram)
+         << "), written " << written << " (" << percent(written, ram) << "), never touched " << untouched
+         << " (" << percent(untouched, ram) << ")" << std::endl;
+   uint32_t outside = 0;
+   for (uint32_t address = ramEnd; address < 0x10000; address++)
+      outside += merged.test(Coverage::READ, (uint16_t)address) || merged.test(Coverage::WRITTEN, (uint16_t)address);
+   if (outside)
+      out << "Above " << hex(ramEnd - 1, 4) << ": " << outside << " bytes read or written" << std::endl;
+
+   if (!missed.empty())
+   {
+      out << std::endl << "Routines never entered:";
+      for (size_t n = 0; n < missed.size(); n++)
+         out << (n % 4 == 0 ? "\n   " : ", ") << hex(missed[n], 4) << " " << routineName(missed[n]);
+      out << std::endl;
+   }
+   if (untouched)
+   {
+      out << std::endl << "RAM never touched:";
+      writeUntouched(out, size, ramEnd);
+   }
+}
+
+void writeListing(std::ostream& out)
+{
+   size_t address = 0;
+   while (address < rom.size())
+   {
+      if (analysis.isRoutine((uint16_t)address) || symbols.at((uint16_t)address, Symbols::CODE))
+         out << std::endl << routineName((uint16_t)address) << ":" << std::endl;
+      else if (const Symbols::Symbol* symbol = symbols.at((uint16_t)address, Symbols::DATA))
+         out << std::endl << symbol->name << ":" << std::endl;
+
+      std::string line;
+      if (analysis.kind[address] == Analysis::CODE)
+      {
+         line = merged.test(Coverage::EXECUTED, (uint16_t)address) ? "X  " : "-  ";
+         address += Opcodes::listing((uint16_t)address, &rom[address], line, operandName);
+         line.erase(line.find_last_not_of(' ') + 1);
+      }
+      else
+      {
+         // Up to 8 bytes of data, all read or all not, stopping at code and labels
+         bool read = merged.test(Coverage::READ, (uint16_t)address);
+         line = read ? "R  " : ".  ";
+         Opcodes::appendHex(line, (unsigned)address, 4);
+         line += "          DB     ";
+         int n = 0;
+         do
+         {
+            line += n ? ",$" : "$";
+            Opcodes::appendHex(line, rom[address++], 2);
+         } while (++n < 8 && address < rom.size() && analysis.kind[address] != Analysis::CODE
+            && merged.test(Coverage::READ, (uint16_t)address) == read && !analysis.isRoutine((uint16_t)address)
+            && !symbols.at((uint16_t)address, Symbols::CODE) && !symbols.at((uint16_t)address, Symbols::DATA));
+      }
+      out << line << std::endl;
+   }
+}
+
+int main(int argc, char** argv)
+{
+   if (argc < 3)
+   {
+      std::cerr << "Usage: " << argv[0] << " <rom> <coverage>... [-list file] [-out file] [-listing file] [-symbols file] [-nocache]" << std::endl;
+      return 1;
+   }
+
+   std::string romFile = argv[1], outFile, listingFile, symbolFile;
+   std::vector<std::string> runs;
+   bool useCache = true;
+   for (int arg = 2; arg < argc; arg++)
+   {
+      std::string option = argv[arg];
+      if (option == "-list" && arg + 1 < argc)
+      {
+         std::ifstream list(argv[++arg]);
+         if (!list)
+         {
+            std::cerr << "Can't read " << argv[arg] << std::endl;
+            return 1;
+         }
+         std::string line;
+         while (std::getline(list, line))
+            if (!line.empty())
+               runs.push_back(line);
+      }
+      else if (option == "-out" && arg + 1 < argc)
+         outFile = argv[++arg];
+      else if (option == "-listing" && arg + 1 < argc)
+         listingFile = argv[++arg];
+      else if (option == "-symbols" && arg + 1 < argc)
+         symbolFile = argv[++arg];
+      else if (option == "-nocache")
+         useCache = false;
+      else if (option[0] == '-')
+      {
+         std::cerr << "Unknown option " << option << std::endl;
+         return 1;
+      }
+      else
+         runs.push_back(option);
+   }
+
+   std::ifstream stream(romFile, std::ios::binary);
+   rom.assign(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+   if (rom.empty() || rom.size() > 0x10000)
+   {
+      std::cerr << "Can't read " << romFile << std::endl;
+      return 1;
+   }
+
+   try
+   {
+      if (symbolFile.empty())
+         symbols.loadDefault(argv[0], std::cerr);
+      else
+         symbols.load(symbolFile);
+   }
+   catch (const std::string& msg)
+   {
+      std::cerr << msg << std::endl;
+      return 1;
+   }
+
+   merged.romHash = Analysis::hash(rom.data(), rom.size());
+   merged.runs = 0;
+   size_t skipped = 0;
+   for (const std::string& file : runs)
+   {
+      if (!run.load(file))
+      {
+         std::cerr << "Can't read " << file << std::endl;
+         return 1;
+      }
+      if (!merged.merge(run))
+      {
+         std::cerr << file << " is a run of another ROM, left out" << std::endl;
+         skipped++;
+      }
+   }
+   if (merged.runs == 0)
+   {
+      std::cerr << "No runs of " << romFile << std::endl;
+      return 1;
+   }
+   if (!outFile.empty() && !merged.save(outFile))
+   {
+      std::cerr << "Can't write " << outFile << std::endl;
+      return 1;
+   }
+
+   analysis.loadOrAnalyze(rom, symbols, romFile + ".analysis", useCache, std::cerr);
+   std::cout << merged.runs << (merged.runs == 1 ? " run" : " runs") << " of " << romFile;
+   if (skipped)
+      std::cout << " (" << skipped << " files of another ROM left out)";
+   std::cout << std::endl;
+   writeSummary(std::cout);
+
+   if (!listingFile.empty())
+   {
+      std::ofstream out(listingFile);
+      writeListing(out);
+      if (!out)
+      {
+         std::cerr << "Can't write " << listingFile << std::endl;
+         return 1;
+      }
+   }
+   return 0;
+}
@@ -0,0 +1,234 @@
+// Static disassembly of a whole ROM, labelled from a symbol map.
+//
+// Usage: Disassemble <rom> [listing] [-nocache] [-symbols file]
+//
+// Walks the code from reset, the two interrupt vectors and every code
+// symbol (see Common/Analysis.h), then writes a listing with labels,
+// cross references on each label, data bytes as DB lines and a call graph
+// at the end. Without a listing file it goes to stdout.
+//
+// The analysis is cached in <rom>.analysis and reused while the ROM is
+// unchanged and the map adds no entry points; -nocache forces a fresh walk.
+// Names come from Common/invaders.sym unless -symbols gives another map.
+
+#include "../Common/Analysis.h"
+#include "../Common/Opcodes.h"
+#include "../Common/Symbols.h"
+
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+std::vector<uint8_t> rom;
+Analysis analysis;
+Symbols symbols;
+std::map<uint16_t, std::string> labels; // Every jump, call and ROM data target
+
+std::string hex(unsigned value, int digits)
+{
+   std::string text;
+   Opcodes::appendHex(text, value, digits);
+   return text;
+}
+
+void makeLabels()
+{
+   for (const Analysis::Xref& xref : analysis.xrefs)
+   {
+      if (xref.to >= rom.size() || labels.count(xref.to))
+         continue;
+      if (xref.type == Analysis::REF_DATA && analysis.kind[xref.to] != Analysis::DATA)
+         continue; // LXI constants that happen to point into code
+      if (const Symbols::Symbol* symbol = symbols.at(xref.to, Symbols::CODE))
+         labels[xref.to] = symbol->name;
+      else if (analysis.isRoutine(xref.to))
+         labels[xref.to] = "sub_" + hex(xref.to, 4);
+      else if (xref.type == Analysis::REF_JUMP)
+         labels[xref.to] = "loc_" + hex(xref.to, 4);
+      else
+         labels[xref.to] = "dat_" + hex(xref.to, 4);
+   }
+   for (uint16_t routine : analysis.routines)
+      if (routine < rom.size() && !labels.count(routine))
+      {
+         const Symbols::Symbol* symbol = symbols.at(routine, Symbols::CODE);
+         labels[routine] = symbol ? symbol->name : "sub_" + hex(routine, 4);
+      }
+}
+
+const char* labelName(uint16_t address, Opcodes::Operand kind, void*)
+{
+   auto label = labels.find(address);
+   if (label != labels.end())
+      return label->second.c_str();
+   return Symbols::lookup(address, kind, &symbols);
+}
+
+// "; xref CALL 0100, JP 0141, LD 1a32" on lines of at most 8. Code labels
+// leave out LD: those are LXI constants, not pointers to the code.
+void writeXrefs(std::ostream& out, uint16_t address)
+{
+   static const char* TYPES[] = { "JP ", "CALL ", "LD " };
+   const Analysis::Xref *first, *last;
+   analysis.referencesTo(address, first, last);
+   bool code = analysis.kind[address] == Analysis::CODE;
+   int column = 0;
+   for (const Analysis::Xref* xref = first; xref != last; xref++)
+   {
+      if (code && xref->type == Analysis::REF_DATA)
+         continue;
+      out << (column == 0 ? "; xref " : column % 8 == 0 ? "\n; xref " : ", ") << TYPES[xref->type] << hex(xref->from, 4);
+      column++;
+   }
+   if (column)
+      out << std::endl;
+}
+
+// The routines `routine` calls or jumps to, walking its own code only
+std::set<uint16_t> calls(uint16_t routine)
+{
+   std::set<uint16_t> callees, visited;
+   std::vector<uint16_t> work = { routine };
+   while (!work.empty())
+   {
+      uint32_t pc = work.back();
+      work.pop_back();
+      while (pc < rom.size() && analysis.kind[pc] == Analysis::CODE && visited.insert((uint16_t)pc).second)
+      {
+         const Opcodes::Info& op = Opcodes::TABLE[rom[pc]];
+         uint16_t target = op.length == 3 ? rom[pc + 1] | rom[pc + 2] << 8 : Opcodes::restartAddress(rom[pc]);
+         if (op.flow == Opcodes::FLOW_CALL || op.flow == Opcodes::FLOW_CALL_IF || op.flow == Opcodes::FLOW_RESTART)
+            callees.insert(target);
+         else if ((op.flow == Opcodes::FLOW_JUMP || op.flow == Opcodes::FLOW_JUMP_IF) && analysis.isRoutine(target))
+            callees.insert(target); // Tail call
+         else if (op.flow == Opcodes::FLOW_JUMP || op.flow == Opcodes::FLOW_JUMP_IF)
+            work.push_back(target);
+         if (op.flow == Opcodes::FLOW_JUMP || op.flow == Opcodes::FLOW_RETURN || op.flow == Opcodes::FLOW_INDIRECT || op.flow == Opcodes::FLOW_HALT)
+            break;
+         pc += op.length;
+      }
+   }
+   return callees;
+}
+
+void writeListing(std::ostream& out)
+{
+   size_t code = analysis.count(Analysis::CODE) + analysis.count(Analysis::OPERAND);
+   size_t data = analysis.count(Analysis::DATA);
+   size_t unknown = analysis.count(Analysis::UNKNOWN);
+   out << "; " << rom.size() << " bytes, xxhash64 " << hex((unsigned)(analysis.romHash >> 32), 8) << hex((unsigned)analysis.romHash, 8) << std::endl
+      << "; code " << code << " bytes (" << code * 100 / rom.size() << "%), referenced data " << data
+      << ", never reached " << unknown << " (" << unknown * 100 / rom.size() << "%)" << std::endl
+      << "; " << analysis.routines.size() << " routines, " << analysis.xrefs.size() << " references, "
+      << analysis.overlaps << " jumps into the middle of an instruction" << std::endl;
+
+   size_t address = 0;
+   while (address < rom.size())
+   {
+      auto label = labels.find((uint16_t)address);
+      if (label != labels.end())
+      {
+         out << std::endl;
+         writeXrefs(out, (uint16_t)address);
+         out << label->second << ":" << std::endl;
+      }
+
+      std::string line;
+      if (analysis.kind[address] == Analysis::CODE)
+      {
+         address += Opcodes::listing((uint16_t)address, &rom[address], line, labelName);
+         line.erase(line.find_last_not_of(' ') + 1);
+      }
+      else
+      {
+         // Up to 8 bytes of data, stopping at code and labels
+         Opcodes::appendHex(line, (unsigned)address, 4);
+         line += "          DB     ";
+         int n = 0;
+         do
+         {
+            line += n ? ",$" : "$";
+            Opcodes::appendHex(line, rom[address++], 2);
+         } while (++n < 8 && address < rom.size() && analysis.kind[address] != Analysis::CODE && !labels.count((uint16_t)address));
+      }
+      out << line << std::endl;
+   }
+
+   // Call graph
+   std::map<uint16_t, std::set<uint16_t>> callees, callers;
+   for (uint16_t routine : analysis.routines)
+      for (uint16_t callee : calls(routine))
+      {
+         callees[routine].insert(callee);
+         callers[callee].insert(routine);
+      }
+   out << std::endl << "; Call graph" << std::endl;
+   for (uint16_t routine : analysis.routines)
+   {
+      out << ";   " << labelName(routine, Opcodes::OPERAND_TARGET, nullptr);
+      for (uint16_t callee : callees[routine])
+         out << (callee == *callees[routine].begin() ? " -> " : ", ") << labelName(callee, Opcodes::OPERAND_TARGET, nullptr);
+      if (callers[routine].empty())
+         out << " (entry point)";
+      out << std::endl;
+   }
+}
+
+int main(int argc, char** argv)
+{
+   if (argc < 2)
+   {
+      std::cerr << "Usage: " << argv[0] << " <rom> [listing] [-nocache] [-symbols file]" << std::endl;
+      return 1;
+   }
+
+   std::string romFile = argv[1], listingFile, symbolFile;
+   bool useCache = true;
+   for (int arg = 2; arg < argc; arg++)
+   {
+      if (std::string(argv[arg]) == "-nocache")
+         useCache = false;
+      else if (std::string(argv[arg]) == "-symbols" && arg + 1 < argc)
+         symbolFile = argv[++arg];
+      else
+         listingFile = argv[arg];
+   }
+
+   try
+   {
+      if (symbolFile.empty())
+         symbols.loadDefault(argv[0], std::cerr);
+      else
+         symbols.load(symbolFile);
+   }
+   catch (const std::string& msg)
+   {
+      std::cerr << msg << std::endl;
+      return 1;
+   }
+
+   std::ifstream stream(romFile, std::ios::binary);
+   rom.assign(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+   if (rom.empty() || rom.size() > 0x10000)
+   {
+      std::cerr << "Can't read " << romFile << std::endl;
+      return 1;
+   }
+
+   std::string cacheFile = romFile + ".analysis";
+   if (analysis.loadOrAnalyze(rom, symbols, cacheFile, useCache, std::cerr))
+      std::cerr << "Using " << cacheFile << std::endl;
+
+   makeLabels();
+   if (listingFile.empty())
+      writeListing(std::cout);
+   else
+   {
+      std::ofstream out(listingFile);
+      writeListing(out);
+   }
+   return 0;
+}
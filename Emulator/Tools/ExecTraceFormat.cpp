@@ -0,0 +1,83 @@
+// Prints an execution trace ring (Intel8080 -exec-trace) as text, one line
+// per instruction in the layout the emulator's old debug output used.
+//
+// Usage: ExecTraceFormat <ring> [first [last]] [-cycles] [-symbols file]
+//
+// first/last are instruction numbers counted from the start of the run;
+// only the newest -exec-trace-records instructions are still in the ring.
+// -cycles prefixes each line with the clock after the instruction.
+// Operands are named from Common/invaders.sym, or from -symbols' file.
+
+#include "../Common/ExecTrace.h"
+#include "../Common/MappedRing.h"
+
+#include <iostream>
+#include <string>
+
+int main(int argc, char** argv)
+{
+   if (argc < 2)
+   {
+      std::cerr << "Usage: " << argv[0] << " <ring> [first [last]] [-cycles] [-symbols file]" << std::endl;
+      return 1;
+   }
+
+   try
+   {
+      MappedRing ring(argv[1]);
+      if (ring.getRecordSize() != sizeof(ExecRecord))
+      {
+         std::cerr << "Not an execution trace" << std::endl;
+         return 1;
+      }
+
+      bool cycles = false;
+      std::string symbolFile;
+      int numbers = 0;
+      uint64_t range[2] = { ring.getFirst(), ring.getWritten() ? ring.getWritten() - 1 : 0 };
+      for (int arg = 2; arg < argc; arg++)
+      {
+         if (std::string(argv[arg]) == "-cycles")
+            cycles = true;
+         else if (std::string(argv[arg]) == "-symbols" && arg + 1 < argc)
+            symbolFile = argv[++arg];
+         else if (numbers < 2)
+            range[numbers++] = std::stoull(argv[arg]);
+      }
+      Symbols symbols;
+      if (symbolFile.empty())
+         symbols.loadDefault(argv[0], std::cerr);
+      else
+         symbols.load(symbolFile);
+      if (numbers == 1)
+         range[1] = range[0];
+      if (ring.getWritten() == 0 || range[0] < ring.getFirst() || range[1] >= ring.getWritten() || range[0] > range[1])
+      {
+         std::cerr << "Instructions " << ring.getFirst() << ".." << (int64_t)ring.getWritten() - 1 << " are in the ring" << std::endl;
+         return 1;
+      }
+
+      std::string text;
+      for (uint64_t n = range[0]; n <= range[1]; n++)
+      {
+         const ExecRecord& record = *(const ExecRecord*)ring.record(n);
+         if (cycles)
+            text += std::to_string(record.cycle) + " ";
+         formatExecRecord(record, text, &symbols);
+         text += '\n';
+         if (text.size() > (1 << 16))
+         {
+            std::cout.write(text.data(), text.size());
+            text.clear();
+         }
+      }
+      std::cout.write(text.data(), text.size());
+   }
+   catch (const std::string& msg)
+   {
+      std::cerr << msg << std::endl;
+      return 1;
+   }
+
+   return 0;
+}
@@ -0,0 +1,64 @@
+// Reconstructs memory dumps from a frame stream (Intel8080 -frames).
+//
+// Usage: FrameExtract <stream> <output prefix> [first [last]]
+//
+// Writes <output prefix><n> for each frame n in [first, last], identical to
+// the memdump/dump/frame<n> files the emulator used to write directly.
+// Without first/last every frame is extracted; with only first, just that one.
+
+#include "../Intel8080/FrameStream.h"
+
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+int main(int argc, char** argv)
+{
+   if (argc < 3)
+   {
+      std::cerr << "Usage: " << argv[0] << " <stream> <output prefix> [first [last]]" << std::endl;
+      return 1;
+   }
+
+   try
+   {
+      FrameStreamReader reader(argv[1]);
+      if (reader.frameCount() == 0)
+      {
+         std::cerr << "No frames" << std::endl;
+         return 1;
+      }
+
+      uint32_t first = 0, last = reader.frameCount() - 1;
+      if (argc > 3)
+         first = last = (uint32_t)std::stoul(argv[3]);
+      if (argc > 4)
+         last = (uint32_t)std::stoul(argv[4]);
+      if (first > last || last >= reader.frameCount())
+      {
+         std::cerr << "Frame range outside 0.." << reader.frameCount() - 1 << std::endl;
+         return 1;
+      }
+
+      std::string prefix = argv[2];
+      std::vector<uint8_t> frame;
+      for (uint32_t n = first; n <= last; n++)
+      {
+         if (!reader.read(n, frame))
+         {
+            std::cerr << "Corrupt stream at frame " << n << std::endl;
+            return 1;
+         }
+         std::ofstream stream(prefix + std::to_string(n), std::ios::binary);
+         stream.write((char*)frame.data(), frame.size());
+      }
+   }
+   catch (const std::string& msg)
+   {
+      std::cerr << msg << std::endl;
+      return 1;
+   }
+
+   return 0;
+}
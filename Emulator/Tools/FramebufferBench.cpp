@@ -0,0 +1,131 @@
+// Checks Framebuffer::convert against the one-pixel-at-a-time reference
+// and times both.
+//
+// Usage: FramebufferBench [frame stream] [iterations]
+//
+// Without a stream it uses random VRAM (plus all off / all on); with one
+// (Intel8080 -frames) every frame in it is checked. Any mismatch prints the
+// first differing pixel and exits with 1.
+
+#include "../Common/Framebuffer.h"
+#include "../Intel8080/FrameStream.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+const int PADDED_PITCH = Framebuffer::WIDTH * 4 + 64; // Locked textures often have a wider pitch
+
+// Converts with both paths at the given pitch (and again in 8 line bands,
+// and packed 1 bit per pixel) and compares every pixel
+bool check(const uint8_t* vram, int pitch, const std::string& name)
+{
+   std::vector<uint8_t> expected(pitch * Framebuffer::HEIGHT, 0x55), actual(expected), banded(expected);
+   Framebuffer::convertReference(vram, (uint32_t*)expected.data(), pitch);
+   Framebuffer::convert(vram, (uint32_t*)actual.data(), pitch);
+   for (int line = 0; line < Framebuffer::WIDTH; line += 8)
+      Framebuffer::convert(vram, (uint32_t*)banded.data(), pitch, line, line + 8);
+
+   std::vector<uint8_t> packed(Framebuffer::WIDTH / 8 * Framebuffer::HEIGHT), unpacked(expected);
+   Framebuffer::convertPacked(vram, packed.data(), Framebuffer::WIDTH / 8);
+   for (int row = 0; row < Framebuffer::HEIGHT; row++)
+      for (int col = 0; col < Framebuffer::WIDTH; col++)
+         Framebuffer::row((uint32_t*)unpacked.data(), pitch, row)[col] =
+            packed[row * Framebuffer::WIDTH / 8 + col / 8] & (0x80 >> col % 8) ? Framebuffer::ON : Framebuffer::OFF;
+
+   for (const std::vector<uint8_t>* result : { &actual, &banded, &unpacked })
+      for (int row = 0; row < Framebuffer::HEIGHT; row++)
+         for (int col = 0; col < Framebuffer::WIDTH; col++)
+         {
+            uint32_t want = Framebuffer::row((uint32_t*)expected.data(), pitch, row)[col];
+            uint32_t got = Framebuffer::row((uint32_t*)result->data(), pitch, row)[col];
+            if (want != got)
+            {
+               std::cerr << name << (result == &banded ? " (banded)" : result == &unpacked ? " (packed)" : "") << ": pixel " << row << "," << col
+                  << " is " << std::hex << got << " expected " << want << std::dec << std::endl;
+               return false;
+            }
+         }
+   return true;
+}
+
+template<typename Convert>
+double nsPerFrame(const uint8_t* vram, int iterations, Convert convert)
+{
+   std::vector<uint32_t> pixels(Framebuffer::WIDTH * Framebuffer::HEIGHT);
+   convert(vram, pixels.data()); // Warm up
+   auto start = std::chrono::steady_clock::now();
+   for (int n = 0; n < iterations; n++)
+      convert(vram, pixels.data());
+   auto elapsed = std::chrono::steady_clock::now() - start;
+   volatile uint32_t sink = pixels[iterations % pixels.size()]; // Keep the work observable
+   (void)sink;
+   return std::chrono::duration<double, std::nano>(elapsed).count() / iterations;
+}
+
+int main(int argc, char** argv)
+{
+   int iterations = argc > 2 ? std::stoi(argv[2]) : 2000;
+   std::vector<std::vector<uint8_t>> screens; // 0x1c00 bytes of VRAM each
+
+   try
+   {
+      if (argc > 1)
+      {
+         FrameStreamReader reader(argv[1]);
+         std::vector<uint8_t> frame;
+         for (uint32_t n = 0; n < reader.frameCount(); n++)
+         {
+            if (!reader.read(n, frame) || frame.size() <= Framebuffer::VRAM)
+               throw std::string("Bad frame ") + std::to_string(n);
+            screens.emplace_back(0x1c00, 0x00); // Dumps stop one byte short of the end of VRAM
+            std::memcpy(screens.back().data(), &frame[Framebuffer::VRAM], std::min<size_t>(0x1c00, frame.size() - Framebuffer::VRAM));
+         }
+      }
+      else
+      {
+         std::mt19937 random(8080);
+         screens.emplace_back(0x1c00, 0x00);
+         screens.emplace_back(0x1c00, 0xff);
+         for (int n = 0; n < 64; n++)
+         {
+            screens.emplace_back(0x1c00);
+            for (uint8_t& byte : screens.back())
+               byte = (uint8_t)random();
+         }
+      }
+   }
+   catch (const std::string& msg)
+   {
+      std::cerr << msg << std::endl;
+      return 1;
+   }
+   if (screens.empty())
+   {
+      std::cerr << "No frames" << std::endl;
+      return 1;
+   }
+
+   for (size_t n = 0; n < screens.size(); n++)
+   {
+      std::string name = "frame " + std::to_string(n);
+      if (!check(screens[n].data(), Framebuffer::WIDTH * 4, name) || !check(screens[n].data(), PADDED_PITCH, name + " padded"))
+         return 1;
+   }
+   std::cout << screens.size() << " frames match the reference" << std::endl;
+
+   const uint8_t* vram = screens[screens.size() / 2].data();
+   double reference = nsPerFrame(vram, iterations / 10 + 1, [](const uint8_t* vram, uint32_t* out) {
+      Framebuffer::convertReference(vram, out, Framebuffer::WIDTH * 4);
+   });
+   double fast = nsPerFrame(vram, iterations, [](const uint8_t* vram, uint32_t* out) {
+      Framebuffer::convert(vram, out, Framebuffer::WIDTH * 4);
+   });
+   std::cout << "reference " << (uint64_t)reference << " ns/frame" << std::endl;
+   std::cout << "transpose + table " << (uint64_t)fast << " ns/frame (" << reference / fast << "x)" << std::endl;
+   return 0;
+}
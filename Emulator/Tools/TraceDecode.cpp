@@ -0,0 +1,66 @@
+// Prints a binary memory access trace (Intel8080 -trace) in the same text
+// layout the emulator used to write to std::cout with print enabled:
+//
+//    <blank line per instruction>
+//    aaaa vv r     memory read
+//    aaaa vv w     memory write
+//    pppp vv I     IN  (port printed twice, as before)
+//    pppp vv O     OUT
+//
+// Usage: TraceDecode <trace file> [-cycles]
+//    -cycles   prefix each instruction with its cycle count and PC
+
+#include "../Intel8080/Trace.h"
+
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+int main(int argc, char** argv)
+{
+   if (argc < 2)
+   {
+      std::cerr << "Usage: " << argv[0] << " <trace file> [-cycles]" << std::endl;
+      return 1;
+   }
+   bool showCycles = argc > 2 && std::string(argv[2]) == "-cycles";
+
+   std::ostream& out = std::cout;
+   out << std::hex << std::setfill('0');
+
+   bool first = true;
+   uint64_t lastCycle = 0;
+   try
+   {
+      TraceReader reader(argv[1]);
+      TraceRecord record;
+      while (reader.next(record))
+      {
+         if (first || record.cycle != lastCycle) // New instruction
+         {
+            out << '\n';
+            if (showCycles)
+               out << std::dec << record.cycle << std::hex << " pc=" << std::setw(4) << record.pc;
+            first = false;
+            lastCycle = record.cycle;
+         }
+
+         out << '\n';
+         if (record.kind == TRACE_IN || record.kind == TRACE_OUT)
+            out << std::setw(2) << (int)record.address << std::setw(2) << (int)record.address;
+         else
+            out << std::setw(4) << (int)record.address;
+         out << ' ' << std::setw(2) << (int)record.value << ' ' << (char)record.kind;
+      }
+   }
+   catch (const std::string& msg)
+   {
+      out << std::flush;
+      std::cerr << (first ? "" : "\n") << msg << std::endl;
+      return 1;
+   }
+   out << std::flush;
+
+   return 0;
+}
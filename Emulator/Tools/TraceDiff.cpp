@@ -0,0 +1,359 @@
+// Finds the first instruction where the emulator and the VHDL CPU disagree.
+//
+// Usage: TraceDiff <ring> <hdl trace> [-writes trace] [-ignore field,...] [-context n] [-symbols file]
+//
+// <ring> is an execution trace from Intel8080 -exec-trace, <hdl trace> the
+// hdl_trace.txt written by VHDL/Tests/TraceTest.vhd: one line per
+// instruction, "pc a psw bc de hl sp" in hex, with "W address data" lines
+// for the memory writes of the instruction line that follows them. Line n
+// is compared with record n, both being the state after instruction n.
+//
+// -writes takes the memory trace of the same run (Intel8080 -trace): the
+// writes it records for each instruction are compared with the W lines,
+// address, data and order. Its records carry the cycle their instruction
+// started at, the clock of the ring record before, so when the ring has
+// wrapped the writes of its oldest instruction can't be told apart and are
+// compared from the next one. Without -writes only the registers are
+// compared.
+//
+// Both traces are read side by side and the tool stops at the first
+// difference, so a divergence early in a long run costs only the lines
+// before it. -ignore leaves fields out, e.g. -ignore psw while the flag
+// logic is known to differ. -context sets how many instructions are shown
+// around the difference (5). -symbols names the operands in the context
+// from another map than Common/invaders.sym.
+
+#include "../Common/ExecTrace.h"
+#include "../Common/MappedRing.h"
+#include "../Intel8080/Trace.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// The fields both traces have
+enum Field { PC, A, PSW, BC, DE, HL, SP, FIELDS };
+const char* FIELD_NAMES[FIELDS] = { "pc", "a", "psw", "bc", "de", "hl", "sp" };
+
+struct State
+{
+   uint16_t field[FIELDS];
+};
+
+struct Write
+{
+   uint16_t address;
+   uint8_t data;
+
+   bool operator==(const Write& other) const { return address == other.address && data == other.data; }
+};
+typedef std::vector<Write> Writes;
+
+uint16_t mask[FIELDS] = { 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff };
+
+State emulatorState(const ExecRecord& record)
+{
+   State state = { { record.pc, record.a, record.psw, (uint16_t)(record.b << 8 | record.c),
+      (uint16_t)(record.d << 8 | record.e), (uint16_t)(record.h << 8 | record.l), record.sp } };
+   for (int n = 0; n < FIELDS; n++)
+      state.field[n] &= mask[n];
+   return state;
+}
+
+bool operator!=(const State& a, const State& b)
+{
+   for (int n = 0; n < FIELDS; n++)
+      if (a.field[n] != b.field[n])
+         return true;
+   return false;
+}
+
+// Reads hdl_trace.txt an instruction at a time
+class HdlTrace
+{
+public:
+   explicit HdlTrace(const std::string& path) : stream(path, std::ios::binary), path(path)
+   {
+      if (!stream)
+         throw std::string("Can't open ") + path;
+   }
+
+   // Next instruction line and the writes before it. `raw` collects their text.
+   bool next(State& state, Writes& writes, std::string* raw = nullptr)
+   {
+      writes.clear();
+      std::string line;
+      while (std::getline(stream, line))
+      {
+         lineNumber++;
+         if (!line.empty() && line.back() == '\r')
+            line.pop_back();
+         if (raw)
+            *raw += line + '\n';
+         if (line.empty())
+            continue;
+         if (line[0] == 'W')
+         {
+            unsigned address, data;
+            if (std::sscanf(line.c_str(), "W %x %x", &address, &data) != 2)
+               throw path + ":" + std::to_string(lineNumber) + ": not a write line";
+            writes.push_back({ (uint16_t)address, (uint8_t)data });
+            continue;
+         }
+         unsigned value[FIELDS];
+         if (std::sscanf(line.c_str(), "%x %x %x %x %x %x %x", &value[PC], &value[A], &value[PSW], &value[BC], &value[DE], &value[HL], &value[SP]) != FIELDS)
+            throw path + ":" + std::to_string(lineNumber) + ": not a trace line";
+         for (int n = 0; n < FIELDS; n++)
+            state.field[n] = (uint16_t)value[n] & mask[n];
+         return true;
+      }
+      return false;
+   }
+
+private:
+   std::ifstream stream;
+   std::string path;
+   uint64_t lineNumber = 0;
+};
+
+// The emulator's writes by instruction, from its memory trace
+class EmulatorWrites
+{
+public:
+   explicit EmulatorWrites(const std::string& path) : reader(path) { more = reader.next(pending); }
+
+   // The writes of the instruction that started at `cycle`. Instructions
+   // must be asked for in order; the records of those skipped are dropped.
+   Writes at(uint64_t cycle)
+   {
+      Writes writes;
+      while (more && pending.cycle <= cycle)
+      {
+         if (pending.cycle == cycle && pending.kind == TRACE_WRITE)
+            writes.push_back({ pending.address, pending.value });
+         more = reader.next(pending);
+      }
+      return writes;
+   }
+
+private:
+   TraceReader reader;
+   TraceRecord pending;
+   bool more;
+};
+
+std::string hex(unsigned value, int digits)
+{
+   std::string text;
+   Opcodes::appendHex(text, value, digits);
+   return text;
+}
+
+// "2400 ff, 2401 00", or "none"
+std::string describe(const Writes& writes)
+{
+   std::string text;
+   for (const Write& write : writes)
+      text += (text.empty() ? "" : ", ") + hex(write.address, 4) + " " + hex(write.data, 2);
+   return text.empty() ? "none" : text;
+}
+
+int main(int argc, char** argv)
+{
+   if (argc < 3)
+   {
+      std::cerr << "Usage: " << argv[0] << " <ring> <hdl trace> [-writes trace] [-ignore field,...] [-context n] [-symbols file]" << std::endl;
+      return 1;
+   }
+
+   int context = 5;
+   std::string symbolFile, writesFile;
+   Symbols symbols;
+   try
+   {
+      for (int arg = 3; arg < argc; arg++)
+      {
+         std::string option = argv[arg];
+         if (option == "-writes" && arg + 1 < argc)
+            writesFile = argv[++arg];
+         else if (option == "-context" && arg + 1 < argc)
+            context = std::max(0, std::stoi(argv[++arg]));
+         else if (option == "-symbols" && arg + 1 < argc)
+            symbolFile = argv[++arg];
+         else if (option == "-ignore" && arg + 1 < argc)
+         {
+            std::stringstream names(argv[++arg]);
+            std::string name;
+            while (std::getline(names, name, ','))
+            {
+               int n = 0;
+               while (n < FIELDS && name != FIELD_NAMES[n])
+                  n++;
+               if (n == FIELDS)
+                  throw "Unknown field " + name + " (pc, a, psw, bc, de, hl, sp)";
+               mask[n] = 0;
+            }
+         }
+         else
+            throw "Unknown option " + option;
+      }
+      if (symbolFile.empty())
+         symbols.loadDefault(argv[0], std::cerr);
+      else
+         symbols.load(symbolFile);
+   }
+   catch (const std::string& msg)
+   {
+      std::cerr << msg << std::endl;
+      return 1;
+   }
+   catch (const std::exception&)
+   {
+      std::cerr << "Bad number in the options" << std::endl;
+      return 1;
+   }
+
+   try
+   {
+      MappedRing ring(argv[1]);
+      if (ring.getRecordSize() != sizeof(ExecRecord))
+      {
+         std::cerr << "Not an execution trace" << std::endl;
+         return 1;
+      }
+      HdlTrace hdl(argv[2]);
+      std::unique_ptr<EmulatorWrites> emulatorWrites(writesFile.empty() ? nullptr : new EmulatorWrites(writesFile));
+      const uint64_t first = ring.getFirst(); // Older records were overwritten
+      const uint64_t written = ring.getWritten();
+      auto record = [&](uint64_t n) -> const ExecRecord& { return *(const ExecRecord*)ring.record(n); };
+
+      // Instruction n's writes, if they can be known
+      auto writesOf = [&](uint64_t n, Writes& writes) {
+         writes.clear();
+         if (!emulatorWrites || (n == first && first > 0))
+            return false;
+         writes = emulatorWrites->at(n == 0 ? 0 : record(n - 1).cycle);
+         return true;
+      };
+
+      State state;
+      Writes hdlWrites, writes;
+      for (uint64_t n = 0; n < first; n++)
+         if (!hdl.next(state, hdlWrites))
+         {
+            std::cerr << "The HDL trace ends before instruction " << first << ", the oldest one in the ring" << std::endl;
+            return 1;
+         }
+
+      // Side by side up to the first difference, keeping the last `context`
+      // instructions of both
+      std::deque<std::string> hdlBefore;
+      std::deque<Writes> writesBefore;
+      std::string raw;
+      bool compared = false; // Writes of the current instruction
+      bool hdlEnded = false;
+      uint64_t n = first;
+      for (; n < written; n++)
+      {
+         raw.clear();
+         if (!hdl.next(state, hdlWrites, &raw))
+         {
+            hdlEnded = true;
+            break;
+         }
+         compared = writesOf(n, writes);
+         if (state != emulatorState(record(n)) || (compared && !(writes == hdlWrites)))
+            break;
+         hdlBefore.push_back(raw);
+         writesBefore.push_back(writes);
+         if ((int)hdlBefore.size() > context)
+         {
+            hdlBefore.pop_front();
+            writesBefore.pop_front();
+         }
+      }
+
+      if (n == written || hdlEnded)
+      {
+         if (n == first)
+         {
+            std::cerr << "The HDL trace ends before instruction " << first << ", the oldest one in the ring" << std::endl;
+            return 1;
+         }
+         std::cout << "Identical for instructions " << first << ".." << n - 1;
+         if (!emulatorWrites)
+            std::cout << " (registers only, no -writes)";
+         if (written > n)
+            std::cout << "; the HDL trace ends there, the emulator ran " << written - n << " more";
+         else if (hdl.next(state, hdlWrites))
+            std::cout << "; the emulator trace ends there, the HDL trace is longer";
+         std::cout << std::endl;
+         return 0;
+      }
+
+      State emulator = emulatorState(record(n));
+      std::cout << "First difference at instruction " << n << ", cycle " << record(n).cycle << ":";
+      for (int field = 0; field < FIELDS; field++)
+         if (emulator.field[field] != state.field[field])
+            std::cout << " " << FIELD_NAMES[field] << " " << hex(emulator.field[field], field == A || field == PSW ? 2 : 4)
+                      << " (HDL " << hex(state.field[field], field == A || field == PSW ? 2 : 4) << ")";
+      if (compared && !(writes == hdlWrites))
+         std::cout << " writes " << describe(writes) << " (HDL " << describe(hdlWrites) << ")";
+      std::cout << std::endl;
+
+      // Emulator writes are listed before their instruction, like the W lines
+      std::cout << std::endl << "Emulator:" << std::endl;
+      uint64_t from = n - hdlBefore.size();
+      for (uint64_t line = from; line < written && line <= n + context; line++)
+      {
+         Writes listed;
+         if (line < n)
+            listed = writesBefore[line - from];
+         else if (line == n)
+            listed = writes;
+         else
+            writesOf(line, listed);
+         for (const Write& write : listed)
+            std::cout << std::string(4 + std::to_string(line).size(), ' ') << "W " << hex(write.address, 4) << " " << hex(write.data, 2) << std::endl;
+         std::string text = line == n ? "> " : "  ";
+         text += std::to_string(line);
+         formatExecRecord(record(line), text, &symbols);
+         std::cout << text << std::endl;
+      }
+
+      std::cout << std::endl << "HDL:" << std::endl;
+      auto print = [](uint64_t number, const std::string& lines, bool marked) {
+         std::stringstream stream(lines);
+         std::string line;
+         while (std::getline(stream, line))
+         {
+            if (line[0] == 'W')
+               std::cout << std::string(4 + std::to_string(number).size(), ' ') << line << std::endl;
+            else
+               std::cout << (marked ? "> " : "  ") << number << " " << line << std::endl;
+         }
+      };
+      for (size_t line = 0; line < hdlBefore.size(); line++)
+         print(from + line, hdlBefore[line], false);
+      print(n, raw, true);
+      for (int line = 1; line <= context; line++)
+      {
+         raw.clear();
+         if (!hdl.next(state, hdlWrites, &raw))
+            break;
+         print(n + line, raw, false);
+      }
+      return 1;
+   }
+   catch (const std::string& msg)
+   {
+      std::cerr << msg << std::endl;
+      return 1;
+   }
+}
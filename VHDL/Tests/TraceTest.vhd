@@ -0,0 +1,197 @@
+--------------------------------------------------------------------------------
+-- Description:
+--    Runs the whole Space Invaders system and writes an instruction trace
+--    that Emulator/Tools/TraceDiff compares with the C++ emulator's
+--    execution trace (Intel8080 -exec-trace).
+--
+--    hdl_trace.txt, all values in hex:
+--       <pc> <a> <psw> <bc> <de> <hl> <sp>   one line per completed instruction
+--       W <address> <data>                   memory write by the next instruction line
+--
+--    TraceDiff compares the W lines with the emulator's memory trace
+--    (Intel8080 -trace) when it is given one with -writes.
+--
+--    An instruction line is written at the following instruction's fetch
+--    (SYNC with M1), so pc is the address of the next instruction and the
+--    registers are the state it starts from, the same as each emulator
+--    trace record.
+--
+--    The CPU registers are read with VHDL-2008 external names, so the design
+--    itself needs no debug ports.
+--------------------------------------------------------------------------------
+library ieee;
+use ieee.std_logic_1164.all;
+library std;
+use std.env.all; -- This can only be used in simulation
+
+use ieee.numeric_std.all;
+use ieee.std_logic_textio.all;
+use std.textio.all;
+
+entity TraceTest is
+end TraceTest;
+
+architecture behavior of TraceTest is
+
+   component Spaceinvaders
+   port(
+--- Regular signals
+         clk50 : in  std_logic;
+         reset : in  std_logic;
+-- Player input
+        credit : in  std_logic;
+      P1_start : in  std_logic;
+       P1_left : in  std_logic;
+      P1_right : in  std_logic;
+       P1_shot : in  std_logic;
+-- VGA signals
+         hsync : out std_logic;
+         vsync : out std_logic;
+
+         vga_r : out std_logic;
+         vga_g : out std_logic;
+         vga_b : out std_logic;
+-- LED signals
+       dataLED : out std_logic_vector(7 downto 0);
+-- Debug
+          addr : out std_logic_vector(15 downto 0);
+          data : out std_logic_vector(7 downto 0);
+       newData : out std_logic
+        );
+   end component;
+
+   --inputs
+   signal clk50 : std_logic := '0';
+   signal reset : std_logic := '0';
+
+   signal credit   : std_logic := '0';
+   signal P1_start : std_logic := '0';
+   signal P1_left  : std_logic := '0';
+   signal P1_right : std_logic := '0';
+   signal P1_shot  : std_logic := '0';
+
+   --outputs
+   signal hsync : std_logic;
+   signal vsync : std_logic;
+   signal vga_r : std_logic;
+   signal vga_g : std_logic;
+   signal vga_b : std_logic;
+   signal dataLED : std_logic_vector(7 downto 0);
+
+   signal addr : std_logic_vector(15 downto 0);
+   signal data : std_logic_vector(7 downto 0);
+   signal newData : std_logic;
+
+   -- Clock period definitions
+   constant clk50_period : time := 20 ns;
+
+   -- How many instructions to trace
+   constant instructions : integer := 1000000;
+
+   -- System signals
+   alias clk     is <<signal .TraceTest.uut.clk     : std_logic>>;
+   alias CE      is <<signal .TraceTest.uut.CE      : std_logic>>;
+   alias SYNC    is <<signal .TraceTest.uut.SYNC    : std_logic>>;
+   alias M_1     is <<signal .TraceTest.uut.M_1     : std_logic>>;
+   alias MEMW_L  is <<signal .TraceTest.uut.MEMW_L  : std_logic>>;
+   alias address is <<signal .TraceTest.uut.address : std_logic_vector(15 downto 0)>>;
+   alias dataBus is <<signal .TraceTest.uut.dataBus : std_logic_vector(7 downto 0)>>;
+
+   -- CPU registers
+   alias A     is <<signal .TraceTest.uut.Inst_CPU.Accumulator : std_logic_vector(7 downto 0)>>;
+   alias Flags is <<signal .TraceTest.uut.Inst_CPU.Flags       : std_logic_vector(4 downto 0)>>;
+   alias B     is <<signal .TraceTest.uut.Inst_CPU.Inst_RA.B   : std_logic_vector(7 downto 0)>>;
+   alias C     is <<signal .TraceTest.uut.Inst_CPU.Inst_RA.C   : std_logic_vector(7 downto 0)>>;
+   alias D     is <<signal .TraceTest.uut.Inst_CPU.Inst_RA.D   : std_logic_vector(7 downto 0)>>;
+   alias E     is <<signal .TraceTest.uut.Inst_CPU.Inst_RA.E   : std_logic_vector(7 downto 0)>>;
+   alias H     is <<signal .TraceTest.uut.Inst_CPU.Inst_RA.H   : std_logic_vector(7 downto 0)>>;
+   alias L     is <<signal .TraceTest.uut.Inst_CPU.Inst_RA.L   : std_logic_vector(7 downto 0)>>;
+   alias SP    is <<signal .TraceTest.uut.Inst_CPU.Inst_RA.SP  : std_logic_vector(15 downto 0)>>;
+
+   file f_out : text;
+begin
+
+   -- instantiate the Unit Under Test (UUT)
+   uut: Spaceinvaders port map (
+          clk50 => clk50,
+          reset => reset,
+
+         credit => credit,
+       P1_start => P1_start,
+        P1_shot => P1_shot,
+        P1_left => P1_left,
+       P1_right => P1_right,
+
+          hsync => hsync,
+          vsync => vsync,
+
+          vga_r => vga_r,
+          vga_g => vga_g,
+          vga_b => vga_b,
+
+          dataLED => dataLED,
+          addr => addr,
+          data => data,
+          newData => newData
+        );
+
+   -- Clock process definitions
+   clk50_process :process
+   begin
+      clk50 <= '0'; wait for clk50_period/2;
+      clk50 <= '1'; wait for clk50_period/2;
+   end process;
+
+   -- Reset, then let the game run
+   stim_proc: process
+   begin
+      reset <= '1';
+      wait for 500 ns;
+      reset <= '0';
+      wait;
+   end process;
+
+   trace_proc: process
+      variable out_line : line;
+      variable first    : boolean := true;    -- No completed instruction at the first fetch
+      variable count    : integer := 0;
+      variable writing  : boolean := false;   -- Inside a MEMW_L pulse
+   begin
+      file_open(f_out, "hdl_trace.txt", write_mode);
+      wait until reset = '0';
+
+      while count < instructions loop
+         wait until rising_edge(clk);
+         if CE = '1' then
+            if SYNC = '1' and M_1 = '1' then
+               if not first then
+                  hwrite(out_line, address);                                         write(out_line, ' ');
+                  hwrite(out_line, A);                                               write(out_line, ' ');
+                  -- PSW: S Z 0 AC 0 P 1 CY
+                  hwrite(out_line, Flags(4) & Flags(3) & '0' & Flags(2) & '0' & Flags(1) & '1' & Flags(0)); write(out_line, ' ');
+                  hwrite(out_line, B & C);                                           write(out_line, ' ');
+                  hwrite(out_line, D & E);                                           write(out_line, ' ');
+                  hwrite(out_line, H & L);                                           write(out_line, ' ');
+                  hwrite(out_line, SP);
+                  writeline(f_out, out_line);
+                  count := count + 1;
+               end if;
+               first := false;
+            end if;
+         end if;
+
+         if MEMW_L = '0' and not writing then
+            write(out_line, string'("W "));
+            hwrite(out_line, address); write(out_line, ' ');
+            hwrite(out_line, dataBus);
+            writeline(f_out, out_line);
+         end if;
+         writing := MEMW_L = '0';
+      end loop;
+
+      file_close(f_out);
+      finish(0);
+      wait;
+   end process;
+
+end;